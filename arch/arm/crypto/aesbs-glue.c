@@ -0,0 +1,507 @@
+/*
+ * linux/arch/arm/crypto/aesbs-glue.c - glue code for NEON bit sliced AES
+ *
+ * The bit sliced code only pays off on eight or more blocks at a time,
+ * so anything shorter, as well as CBC encryption, which is inherently
+ * sequential, is handed to the scalar aes-armv4 code. The same goes for
+ * callers in interrupt context, where NEON may not be used.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/module.h>
+#include <linux/crypto.h>
+#include <crypto/aes.h>
+#include <crypto/algapi.h>
+#include <crypto/b128ops.h>
+#include <crypto/gf128mul.h>
+#include <asm/neon.h>
+#include <asm/simd.h>
+
+#include "aesbs.h"
+
+struct aesbs_ctx {
+	struct aesbs_key	bs;
+	AES_KEY			enc;
+	AES_KEY			dec;
+};
+
+struct aesbs_xts_ctx {
+	struct aesbs_ctx	data;
+	AES_KEY			twkey;
+};
+
+#define SWAPN(cl, ch, s, x, y)					\
+	do {							\
+		u32 a = (x), b = (y);				\
+		(x) = (a & (cl)) | ((b & (cl)) << (s));		\
+		(y) = ((a & (ch)) >> (s)) | (b & (ch));		\
+	} while (0)
+
+#define SWAP2(x, y)	SWAPN(0x55555555, 0xaaaaaaaa, 1, x, y)
+#define SWAP4(x, y)	SWAPN(0x33333333, 0xcccccccc, 2, x, y)
+#define SWAP8(x, y)	SWAPN(0x0f0f0f0f, 0xf0f0f0f0, 4, x, y)
+
+/*
+ * Convert the standard key schedule to the bit sliced layout. Both halves
+ * of each lane hold the same round key, as do all four lanes.
+ */
+static void aesbs_convert_key(struct aesbs_key *bs, const u32 *rk, int rounds)
+{
+	int i, j, k;
+
+	bs->rounds = rounds;
+	for (i = 0; i <= rounds; i++) {
+		u32 q[8];
+
+		for (j = 0; j < 4; j++)
+			q[2 * j] = q[2 * j + 1] = rk[4 * i + j];
+
+		SWAP2(q[0], q[1]);
+		SWAP2(q[2], q[3]);
+		SWAP2(q[4], q[5]);
+		SWAP2(q[6], q[7]);
+
+		SWAP4(q[0], q[2]);
+		SWAP4(q[1], q[3]);
+		SWAP4(q[4], q[6]);
+		SWAP4(q[5], q[7]);
+
+		SWAP8(q[0], q[4]);
+		SWAP8(q[1], q[5]);
+		SWAP8(q[2], q[6]);
+		SWAP8(q[3], q[7]);
+
+		for (j = 0; j < 8; j++)
+			for (k = 0; k < 4; k++)
+				bs->rk[8 * i + j][k] = q[j];
+	}
+}
+
+static int aesbs_expand_key(struct aesbs_ctx *ctx, const u8 *in_key,
+			    unsigned int key_len)
+{
+	struct crypto_aes_ctx rk;
+	int bits = key_len * 8;
+	int err;
+
+	err = crypto_aes_expand_key(&rk, in_key, key_len);
+	if (err)
+		return err;
+
+	aesbs_convert_key(&ctx->bs, rk.key_enc, 6 + key_len / 4);
+	memset(&rk, 0, sizeof(rk));
+
+	if (private_AES_set_encrypt_key(in_key, bits, &ctx->enc) == -1)
+		return -EINVAL;
+	/* private_AES_set_decrypt_key expects an encryption key as input */
+	ctx->dec = ctx->enc;
+	if (private_AES_set_decrypt_key(in_key, bits, &ctx->dec) == -1)
+		return -EINVAL;
+	return 0;
+}
+
+static int aesbs_set_key(struct crypto_tfm *tfm, const u8 *in_key,
+			 unsigned int key_len)
+{
+	struct aesbs_ctx *ctx = crypto_tfm_ctx(tfm);
+
+	if (aesbs_expand_key(ctx, in_key, key_len)) {
+		tfm->crt_flags |= CRYPTO_TFM_RES_BAD_KEY_LEN;
+		return -EINVAL;
+	}
+	return 0;
+}
+
+static int aesbs_xts_set_key(struct crypto_tfm *tfm, const u8 *in_key,
+			     unsigned int key_len)
+{
+	struct aesbs_xts_ctx *ctx = crypto_tfm_ctx(tfm);
+	unsigned int half = key_len / 2;
+
+	if ((key_len % 2) || aesbs_expand_key(&ctx->data, in_key, half) ||
+	    private_AES_set_encrypt_key(in_key + half, half * 8,
+					&ctx->twkey) == -1) {
+		tfm->crt_flags |= CRYPTO_TFM_RES_BAD_KEY_LEN;
+		return -EINVAL;
+	}
+	return 0;
+}
+
+/* Number of blocks at the head of a walk step that go to the NEON code */
+static unsigned int aesbs_neon_blocks(unsigned int blocks)
+{
+	if (blocks < AESBS_BLOCKS || !may_use_simd())
+		return 0;
+	return round_down(blocks, AESBS_BLOCKS);
+}
+
+static int aesbs_ecb_crypt(struct blkcipher_desc *desc,
+			   struct scatterlist *dst, struct scatterlist *src,
+			   unsigned int nbytes, AES_KEY *key,
+			   asmlinkage void (*fn)(const u8 *, u8 *, AES_KEY *),
+			   void (*bs_fn)(u8 *, const u8 *, unsigned int,
+					 const struct aesbs_key *))
+{
+	struct aesbs_ctx *ctx = crypto_blkcipher_ctx(desc->tfm);
+	struct blkcipher_walk walk;
+	int err;
+
+	blkcipher_walk_init(&walk, dst, src, nbytes);
+	err = blkcipher_walk_virt_block(desc, &walk, AESBS_BLOCK_BYTES);
+
+	while (walk.nbytes) {
+		unsigned int blocks = walk.nbytes / AES_BLOCK_SIZE;
+		unsigned int done = aesbs_neon_blocks(blocks);
+		u8 *out = walk.dst.virt.addr;
+		u8 *in = walk.src.virt.addr;
+
+		if (done) {
+			kernel_neon_begin();
+			bs_fn(out, in, done, &ctx->bs);
+			kernel_neon_end();
+		}
+		for (; done < blocks; done++)
+			fn(in + done * AES_BLOCK_SIZE,
+			   out + done * AES_BLOCK_SIZE, key);
+
+		err = blkcipher_walk_done(desc, &walk,
+					  walk.nbytes % AES_BLOCK_SIZE);
+	}
+	return err;
+}
+
+static int aesbs_ecb_encrypt(struct blkcipher_desc *desc,
+			     struct scatterlist *dst, struct scatterlist *src,
+			     unsigned int nbytes)
+{
+	struct aesbs_ctx *ctx = crypto_blkcipher_ctx(desc->tfm);
+
+	return aesbs_ecb_crypt(desc, dst, src, nbytes, &ctx->enc,
+			       AES_encrypt, aesbs_ecb_encrypt_neon);
+}
+
+static int aesbs_ecb_decrypt(struct blkcipher_desc *desc,
+			     struct scatterlist *dst, struct scatterlist *src,
+			     unsigned int nbytes)
+{
+	struct aesbs_ctx *ctx = crypto_blkcipher_ctx(desc->tfm);
+
+	return aesbs_ecb_crypt(desc, dst, src, nbytes, &ctx->dec,
+			       AES_decrypt, aesbs_ecb_decrypt_neon);
+}
+
+static int aesbs_cbc_encrypt(struct blkcipher_desc *desc,
+			     struct scatterlist *dst, struct scatterlist *src,
+			     unsigned int nbytes)
+{
+	struct aesbs_ctx *ctx = crypto_blkcipher_ctx(desc->tfm);
+	struct blkcipher_walk walk;
+	int err;
+
+	blkcipher_walk_init(&walk, dst, src, nbytes);
+	err = blkcipher_walk_virt(desc, &walk);
+
+	while (walk.nbytes) {
+		unsigned int blocks = walk.nbytes / AES_BLOCK_SIZE;
+		u8 *out = walk.dst.virt.addr;
+		u8 *in = walk.src.virt.addr;
+		u8 *iv = walk.iv;
+
+		for (; blocks; blocks--) {
+			crypto_xor(iv, in, AES_BLOCK_SIZE);
+			AES_encrypt(iv, out, &ctx->enc);
+			iv = out;
+			in += AES_BLOCK_SIZE;
+			out += AES_BLOCK_SIZE;
+		}
+		memcpy(walk.iv, iv, AES_BLOCK_SIZE);
+
+		err = blkcipher_walk_done(desc, &walk,
+					  walk.nbytes % AES_BLOCK_SIZE);
+	}
+	return err;
+}
+
+static int aesbs_cbc_decrypt(struct blkcipher_desc *desc,
+			     struct scatterlist *dst, struct scatterlist *src,
+			     unsigned int nbytes)
+{
+	struct aesbs_ctx *ctx = crypto_blkcipher_ctx(desc->tfm);
+	struct blkcipher_walk walk;
+	int err;
+
+	blkcipher_walk_init(&walk, dst, src, nbytes);
+	err = blkcipher_walk_virt_block(desc, &walk, AESBS_BLOCK_BYTES);
+
+	while (walk.nbytes) {
+		unsigned int blocks = walk.nbytes / AES_BLOCK_SIZE;
+		unsigned int done = aesbs_neon_blocks(blocks);
+		u8 *out = walk.dst.virt.addr;
+		u8 *in = walk.src.virt.addr;
+
+		if (done) {
+			kernel_neon_begin();
+			aesbs_cbc_decrypt_neon(out, in, done, &ctx->bs,
+					       walk.iv);
+			kernel_neon_end();
+			in += done * AES_BLOCK_SIZE;
+			out += done * AES_BLOCK_SIZE;
+		}
+		for (; done < blocks; done++) {
+			u8 prev[AES_BLOCK_SIZE];
+
+			memcpy(prev, in, AES_BLOCK_SIZE);
+			AES_decrypt(in, out, &ctx->dec);
+			crypto_xor(out, walk.iv, AES_BLOCK_SIZE);
+			memcpy(walk.iv, prev, AES_BLOCK_SIZE);
+			in += AES_BLOCK_SIZE;
+			out += AES_BLOCK_SIZE;
+		}
+
+		err = blkcipher_walk_done(desc, &walk,
+					  walk.nbytes % AES_BLOCK_SIZE);
+	}
+	return err;
+}
+
+static int aesbs_ctr_encrypt(struct blkcipher_desc *desc,
+			     struct scatterlist *dst, struct scatterlist *src,
+			     unsigned int nbytes)
+{
+	struct aesbs_ctx *ctx = crypto_blkcipher_ctx(desc->tfm);
+	struct blkcipher_walk walk;
+	u8 ks[AES_BLOCK_SIZE];
+	int err;
+
+	blkcipher_walk_init(&walk, dst, src, nbytes);
+	err = blkcipher_walk_virt_block(desc, &walk, AESBS_BLOCK_BYTES);
+
+	while (walk.nbytes >= AES_BLOCK_SIZE) {
+		unsigned int blocks = walk.nbytes / AES_BLOCK_SIZE;
+		unsigned int done = aesbs_neon_blocks(blocks);
+		u8 *out = walk.dst.virt.addr;
+		u8 *in = walk.src.virt.addr;
+
+		if (done) {
+			kernel_neon_begin();
+			aesbs_ctr_encrypt_neon(out, in, done, &ctx->bs,
+					       walk.iv);
+			kernel_neon_end();
+			in += done * AES_BLOCK_SIZE;
+			out += done * AES_BLOCK_SIZE;
+		}
+		for (; done < blocks; done++) {
+			AES_encrypt(walk.iv, ks, &ctx->enc);
+			if (out != in)
+				memcpy(out, in, AES_BLOCK_SIZE);
+			crypto_xor(out, ks, AES_BLOCK_SIZE);
+			crypto_inc(walk.iv, AES_BLOCK_SIZE);
+			in += AES_BLOCK_SIZE;
+			out += AES_BLOCK_SIZE;
+		}
+
+		err = blkcipher_walk_done(desc, &walk,
+					  walk.nbytes % AES_BLOCK_SIZE);
+	}
+
+	/* final partial block */
+	if (walk.nbytes) {
+		u8 *out = walk.dst.virt.addr;
+		u8 *in = walk.src.virt.addr;
+
+		AES_encrypt(walk.iv, ks, &ctx->enc);
+		crypto_xor(ks, in, walk.nbytes);
+		memcpy(out, ks, walk.nbytes);
+		crypto_inc(walk.iv, AES_BLOCK_SIZE);
+		err = blkcipher_walk_done(desc, &walk, 0);
+	}
+	return err;
+}
+
+static int aesbs_xts_crypt(struct blkcipher_desc *desc,
+			   struct scatterlist *dst, struct scatterlist *src,
+			   unsigned int nbytes, AES_KEY *key,
+			   asmlinkage void (*fn)(const u8 *, u8 *, AES_KEY *),
+			   void (*bs_fn)(u8 *, const u8 *, unsigned int,
+					 const struct aesbs_key *, u8 *))
+{
+	struct aesbs_xts_ctx *ctx = crypto_blkcipher_ctx(desc->tfm);
+	struct blkcipher_walk walk;
+	int err;
+
+	blkcipher_walk_init(&walk, dst, src, nbytes);
+	err = blkcipher_walk_virt_block(desc, &walk, AESBS_BLOCK_BYTES);
+	if (!walk.nbytes)
+		return err;
+
+	/* generate the initial tweak */
+	AES_encrypt(walk.iv, walk.iv, &ctx->twkey);
+
+	while (walk.nbytes) {
+		unsigned int blocks = walk.nbytes / AES_BLOCK_SIZE;
+		unsigned int done = aesbs_neon_blocks(blocks);
+		u8 *out = walk.dst.virt.addr;
+		u8 *in = walk.src.virt.addr;
+
+		if (done) {
+			kernel_neon_begin();
+			bs_fn(out, in, done, &ctx->data.bs, walk.iv);
+			kernel_neon_end();
+			in += done * AES_BLOCK_SIZE;
+			out += done * AES_BLOCK_SIZE;
+		}
+		for (; done < blocks; done++) {
+			be128_xor((be128 *)out, (be128 *)walk.iv,
+				  (be128 *)in);
+			fn(out, out, key);
+			be128_xor((be128 *)out, (be128 *)out,
+				  (be128 *)walk.iv);
+			gf128mul_x_ble((be128 *)walk.iv, (be128 *)walk.iv);
+			in += AES_BLOCK_SIZE;
+			out += AES_BLOCK_SIZE;
+		}
+
+		err = blkcipher_walk_done(desc, &walk,
+					  walk.nbytes % AES_BLOCK_SIZE);
+	}
+	return err;
+}
+
+static int aesbs_xts_encrypt(struct blkcipher_desc *desc,
+			     struct scatterlist *dst, struct scatterlist *src,
+			     unsigned int nbytes)
+{
+	struct aesbs_xts_ctx *ctx = crypto_blkcipher_ctx(desc->tfm);
+
+	return aesbs_xts_crypt(desc, dst, src, nbytes, &ctx->data.enc,
+			       AES_encrypt, aesbs_xts_encrypt_neon);
+}
+
+static int aesbs_xts_decrypt(struct blkcipher_desc *desc,
+			     struct scatterlist *dst, struct scatterlist *src,
+			     unsigned int nbytes)
+{
+	struct aesbs_xts_ctx *ctx = crypto_blkcipher_ctx(desc->tfm);
+
+	return aesbs_xts_crypt(desc, dst, src, nbytes, &ctx->data.dec,
+			       AES_decrypt, aesbs_xts_decrypt_neon);
+}
+
+static struct crypto_alg aesbs_algs[] = { {
+	.cra_name		= "ecb(aes)",
+	.cra_driver_name	= "ecb-aes-neonbs",
+	.cra_priority		= 250,
+	.cra_flags		= CRYPTO_ALG_TYPE_BLKCIPHER,
+	.cra_blocksize		= AES_BLOCK_SIZE,
+	.cra_ctxsize		= sizeof(struct aesbs_ctx),
+	.cra_type		= &crypto_blkcipher_type,
+	.cra_module		= THIS_MODULE,
+	.cra_list		= LIST_HEAD_INIT(aesbs_algs[0].cra_list),
+	.cra_u = {
+		.blkcipher = {
+			.min_keysize	= AES_MIN_KEY_SIZE,
+			.max_keysize	= AES_MAX_KEY_SIZE,
+			.setkey		= aesbs_set_key,
+			.encrypt	= aesbs_ecb_encrypt,
+			.decrypt	= aesbs_ecb_decrypt,
+		},
+	},
+}, {
+	.cra_name		= "cbc(aes)",
+	.cra_driver_name	= "cbc-aes-neonbs",
+	.cra_priority		= 250,
+	.cra_flags		= CRYPTO_ALG_TYPE_BLKCIPHER,
+	.cra_blocksize		= AES_BLOCK_SIZE,
+	.cra_ctxsize		= sizeof(struct aesbs_ctx),
+	.cra_type		= &crypto_blkcipher_type,
+	.cra_module		= THIS_MODULE,
+	.cra_list		= LIST_HEAD_INIT(aesbs_algs[1].cra_list),
+	.cra_u = {
+		.blkcipher = {
+			.min_keysize	= AES_MIN_KEY_SIZE,
+			.max_keysize	= AES_MAX_KEY_SIZE,
+			.ivsize		= AES_BLOCK_SIZE,
+			.setkey		= aesbs_set_key,
+			.encrypt	= aesbs_cbc_encrypt,
+			.decrypt	= aesbs_cbc_decrypt,
+		},
+	},
+}, {
+	.cra_name		= "ctr(aes)",
+	.cra_driver_name	= "ctr-aes-neonbs",
+	.cra_priority		= 250,
+	.cra_flags		= CRYPTO_ALG_TYPE_BLKCIPHER,
+	.cra_blocksize		= 1,
+	.cra_ctxsize		= sizeof(struct aesbs_ctx),
+	.cra_type		= &crypto_blkcipher_type,
+	.cra_module		= THIS_MODULE,
+	.cra_list		= LIST_HEAD_INIT(aesbs_algs[2].cra_list),
+	.cra_u = {
+		.blkcipher = {
+			.min_keysize	= AES_MIN_KEY_SIZE,
+			.max_keysize	= AES_MAX_KEY_SIZE,
+			.ivsize		= AES_BLOCK_SIZE,
+			.setkey		= aesbs_set_key,
+			.encrypt	= aesbs_ctr_encrypt,
+			.decrypt	= aesbs_ctr_encrypt,
+			.geniv		= "chainiv",
+		},
+	},
+}, {
+	.cra_name		= "xts(aes)",
+	.cra_driver_name	= "xts-aes-neonbs",
+	.cra_priority		= 250,
+	.cra_flags		= CRYPTO_ALG_TYPE_BLKCIPHER,
+	.cra_blocksize		= AES_BLOCK_SIZE,
+	.cra_ctxsize		= sizeof(struct aesbs_xts_ctx),
+	.cra_type		= &crypto_blkcipher_type,
+	.cra_module		= THIS_MODULE,
+	.cra_list		= LIST_HEAD_INIT(aesbs_algs[3].cra_list),
+	.cra_u = {
+		.blkcipher = {
+			.min_keysize	= 2 * AES_MIN_KEY_SIZE,
+			.max_keysize	= 2 * AES_MAX_KEY_SIZE,
+			.ivsize		= AES_BLOCK_SIZE,
+			.setkey		= aesbs_xts_set_key,
+			.encrypt	= aesbs_xts_encrypt,
+			.decrypt	= aesbs_xts_decrypt,
+		},
+	},
+} };
+
+static int __init aesbs_mod_init(void)
+{
+	int err, i;
+
+	if (!cpu_has_neon())
+		return -ENODEV;
+
+	for (i = 0; i < ARRAY_SIZE(aesbs_algs); i++) {
+		err = crypto_register_alg(&aesbs_algs[i]);
+		if (err)
+			goto unregister;
+	}
+	return 0;
+
+unregister:
+	while (--i >= 0)
+		crypto_unregister_alg(&aesbs_algs[i]);
+	return err;
+}
+
+static void __exit aesbs_mod_exit(void)
+{
+	int i;
+
+	for (i = ARRAY_SIZE(aesbs_algs) - 1; i >= 0; i--)
+		crypto_unregister_alg(&aesbs_algs[i]);
+}
+
+module_init(aesbs_mod_init);
+module_exit(aesbs_mod_exit);
+
+MODULE_DESCRIPTION("Bit sliced AES in ECB/CBC/CTR/XTS modes using NEON");
+MODULE_LICENSE("GPL");
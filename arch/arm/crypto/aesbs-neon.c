@@ -0,0 +1,545 @@
+/*
+ * linux/arch/arm/crypto/aesbs-neon.c
+ *
+ * Bit sliced AES using NEON, for the modes that allow several blocks to
+ * be processed in parallel: ECB, CBC decryption, CTR and XTS.
+ *
+ * Eight blocks are processed at a time, using the representation of the
+ * constant time 'aes_ct' code in BearSSL by Thomas Pornin, widened to the
+ * four 32-bit lanes of a NEON register: lane i carries blocks i and i + 4.
+ * After orthogonalization, word j of the state holds bit j of each byte
+ * of the blocks, SubBytes becomes the Boyar-Peralta boolean circuit, and
+ * ShiftRows and MixColumns reduce to shifts and rotations. There are no
+ * table lookups, hence no data dependent memory accesses either.
+ *
+ * The code relies on the GCC vector extensions rather than on intrinsics
+ * or assembler, and must be built with '-mfloat-abi=softfp -mfpu=neon'.
+ * It may only be called between kernel_neon_begin() and kernel_neon_end().
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/string.h>
+#include <crypto/algapi.h>
+#include <asm/unaligned.h>
+
+#include "aesbs.h"
+
+#ifndef __ARM_NEON__
+#error You should compile this file with '-mfloat-abi=softfp -mfpu=neon'
+#endif
+
+typedef u32 u32x4 __attribute__((vector_size(16)));
+typedef u8 u8x16 __attribute__((vector_size(16)));
+
+#define SPLAT(x)	((u32x4){ (x), (x), (x), (x) })
+
+#define SWAPN(cl, ch, s, x, y)						\
+	do {								\
+		u32x4 a = (x), b = (y);					\
+		(x) = (a & SPLAT(cl)) | ((b & SPLAT(cl)) << SPLAT(s));	\
+		(y) = ((a & SPLAT(ch)) >> SPLAT(s)) | (b & SPLAT(ch));	\
+	} while (0)
+
+#define SWAP2(x, y)	SWAPN(0x55555555, 0xaaaaaaaa, 1, x, y)
+#define SWAP4(x, y)	SWAPN(0x33333333, 0xcccccccc, 2, x, y)
+#define SWAP8(x, y)	SWAPN(0x0f0f0f0f, 0xf0f0f0f0, 4, x, y)
+
+/* Convert between the bytewise and the bit sliced representation */
+static inline void ortho(u32x4 q[8])
+{
+	SWAP2(q[0], q[1]);
+	SWAP2(q[2], q[3]);
+	SWAP2(q[4], q[5]);
+	SWAP2(q[6], q[7]);
+
+	SWAP4(q[0], q[2]);
+	SWAP4(q[1], q[3]);
+	SWAP4(q[4], q[6]);
+	SWAP4(q[5], q[7]);
+
+	SWAP8(q[0], q[4]);
+	SWAP8(q[1], q[5]);
+	SWAP8(q[2], q[6]);
+	SWAP8(q[3], q[7]);
+}
+
+union aesbs_lanes {
+	u32x4	v;
+	u32	w[4];
+};
+
+static inline void load_blocks(u32x4 q[8], const u8 *in)
+{
+	union aesbs_lanes t;
+	int i, j;
+
+	for (j = 0; j < 4; j++) {
+		for (i = 0; i < 4; i++)
+			t.w[i] = get_unaligned_le32(in + 16 * i + 4 * j);
+		q[2 * j] = t.v;
+		for (i = 0; i < 4; i++)
+			t.w[i] = get_unaligned_le32(in + 16 * (i + 4) + 4 * j);
+		q[2 * j + 1] = t.v;
+	}
+	ortho(q);
+}
+
+static inline void store_blocks(u8 *out, u32x4 q[8])
+{
+	union aesbs_lanes t;
+	int i, j;
+
+	ortho(q);
+	for (j = 0; j < 4; j++) {
+		t.v = q[2 * j];
+		for (i = 0; i < 4; i++)
+			put_unaligned_le32(t.w[i], out + 16 * i + 4 * j);
+		t.v = q[2 * j + 1];
+		for (i = 0; i < 4; i++)
+			put_unaligned_le32(t.w[i], out + 16 * (i + 4) + 4 * j);
+	}
+}
+
+static inline void add_round_key(u32x4 q[8], const u32 (*rk)[4])
+{
+	const u32x4 *k = (const u32x4 *)rk;
+	int i;
+
+	for (i = 0; i < 8; i++)
+		q[i] ^= k[i];
+}
+
+/*
+ * The SubBytes circuit of Boyar and Peralta (2009): 113 gates, of which
+ * 32 are ANDs. x0 is the most significant bit of the input byte.
+ */
+static inline void sub_bytes(u32x4 q[8])
+{
+	u32x4 x0, x1, x2, x3, x4, x5, x6, x7;
+	u32x4 y1, y2, y3, y4, y5, y6, y7, y8, y9;
+	u32x4 y10, y11, y12, y13, y14, y15, y16, y17, y18, y19;
+	u32x4 y20, y21;
+	u32x4 z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+	u32x4 z10, z11, z12, z13, z14, z15, z16, z17;
+	u32x4 t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+	u32x4 t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+	u32x4 t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+	u32x4 t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+	u32x4 t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+	u32x4 t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+	u32x4 t60, t61, t62, t63, t64, t65, t66, t67;
+	u32x4 s0, s1, s2, s3, s4, s5, s6, s7;
+
+	x0 = q[7];
+	x1 = q[6];
+	x2 = q[5];
+	x3 = q[4];
+	x4 = q[3];
+	x5 = q[2];
+	x6 = q[1];
+	x7 = q[0];
+
+	/* Top linear transformation */
+	y14 = x3 ^ x5;
+	y13 = x0 ^ x6;
+	y9 = x0 ^ x3;
+	y8 = x0 ^ x5;
+	t0 = x1 ^ x2;
+	y1 = t0 ^ x7;
+	y4 = y1 ^ x3;
+	y12 = y13 ^ y14;
+	y2 = y1 ^ x0;
+	y5 = y1 ^ x6;
+	y3 = y5 ^ y8;
+	t1 = x4 ^ y12;
+	y15 = t1 ^ x5;
+	y20 = t1 ^ x1;
+	y6 = y15 ^ x7;
+	y10 = y15 ^ t0;
+	y11 = y20 ^ y9;
+	y7 = x7 ^ y11;
+	y17 = y10 ^ y11;
+	y19 = y10 ^ y8;
+	y16 = t0 ^ y11;
+	y21 = y13 ^ y16;
+	y18 = x0 ^ y16;
+
+	/* Non-linear section */
+	t2 = y12 & y15;
+	t3 = y3 & y6;
+	t4 = t3 ^ t2;
+	t5 = y4 & x7;
+	t6 = t5 ^ t2;
+	t7 = y13 & y16;
+	t8 = y5 & y1;
+	t9 = t8 ^ t7;
+	t10 = y2 & y7;
+	t11 = t10 ^ t7;
+	t12 = y9 & y11;
+	t13 = y14 & y17;
+	t14 = t13 ^ t12;
+	t15 = y8 & y10;
+	t16 = t15 ^ t12;
+	t17 = t4 ^ t14;
+	t18 = t6 ^ t16;
+	t19 = t9 ^ t14;
+	t20 = t11 ^ t16;
+	t21 = t17 ^ y20;
+	t22 = t18 ^ y19;
+	t23 = t19 ^ y21;
+	t24 = t20 ^ y18;
+
+	t25 = t21 ^ t22;
+	t26 = t21 & t23;
+	t27 = t24 ^ t26;
+	t28 = t25 & t27;
+	t29 = t28 ^ t22;
+	t30 = t23 ^ t24;
+	t31 = t22 ^ t26;
+	t32 = t31 & t30;
+	t33 = t32 ^ t24;
+	t34 = t23 ^ t33;
+	t35 = t27 ^ t33;
+	t36 = t24 & t35;
+	t37 = t36 ^ t34;
+	t38 = t27 ^ t36;
+	t39 = t29 & t38;
+	t40 = t25 ^ t39;
+
+	t41 = t40 ^ t37;
+	t42 = t29 ^ t33;
+	t43 = t29 ^ t40;
+	t44 = t33 ^ t37;
+	t45 = t42 ^ t41;
+	z0 = t44 & y15;
+	z1 = t37 & y6;
+	z2 = t33 & x7;
+	z3 = t43 & y16;
+	z4 = t40 & y1;
+	z5 = t29 & y7;
+	z6 = t42 & y11;
+	z7 = t45 & y17;
+	z8 = t41 & y10;
+	z9 = t44 & y12;
+	z10 = t37 & y3;
+	z11 = t33 & y4;
+	z12 = t43 & y13;
+	z13 = t40 & y5;
+	z14 = t29 & y2;
+	z15 = t42 & y9;
+	z16 = t45 & y14;
+	z17 = t41 & y8;
+
+	/* Bottom linear transformation */
+	t46 = z15 ^ z16;
+	t47 = z10 ^ z11;
+	t48 = z5 ^ z13;
+	t49 = z9 ^ z10;
+	t50 = z2 ^ z12;
+	t51 = z2 ^ z5;
+	t52 = z7 ^ z8;
+	t53 = z0 ^ z3;
+	t54 = z6 ^ z7;
+	t55 = z16 ^ z17;
+	t56 = z12 ^ t48;
+	t57 = t50 ^ t53;
+	t58 = z4 ^ t46;
+	t59 = z3 ^ t54;
+	t60 = t46 ^ t57;
+	t61 = z14 ^ t57;
+	t62 = t52 ^ t58;
+	t63 = t49 ^ t58;
+	t64 = z4 ^ t59;
+	t65 = t61 ^ t62;
+	t66 = z1 ^ t63;
+	s0 = t59 ^ t63;
+	s6 = t56 ^ ~t62;
+	s7 = t48 ^ ~t60;
+	t67 = t64 ^ t65;
+	s3 = t53 ^ t66;
+	s4 = t51 ^ t66;
+	s5 = t47 ^ t65;
+	s1 = t64 ^ ~s3;
+	s2 = t55 ^ ~t67;
+
+	q[7] = s0;
+	q[6] = s1;
+	q[5] = s2;
+	q[4] = s3;
+	q[3] = s4;
+	q[2] = s5;
+	q[1] = s6;
+	q[0] = s7;
+}
+
+/*
+ * The inverse S-box is the forward one wrapped in the inverse of its
+ * affine transform: A^-1(S(A^-1(x))) == S^-1(x), with A^-1 being a
+ * rotation and XOR pattern on the bit planes followed by XOR with 0x05.
+ */
+static inline void inv_affine(u32x4 q[8])
+{
+	u32x4 q0 = ~q[0], q1 = ~q[1], q2 = q[2], q3 = q[3];
+	u32x4 q4 = q[4], q5 = ~q[5], q6 = ~q[6], q7 = q[7];
+
+	q[7] = q1 ^ q4 ^ q6;
+	q[6] = q0 ^ q3 ^ q5;
+	q[5] = q7 ^ q2 ^ q4;
+	q[4] = q6 ^ q1 ^ q3;
+	q[3] = q5 ^ q0 ^ q2;
+	q[2] = q4 ^ q7 ^ q1;
+	q[1] = q3 ^ q6 ^ q0;
+	q[0] = q2 ^ q5 ^ q7;
+}
+
+static inline void inv_sub_bytes(u32x4 q[8])
+{
+	inv_affine(q);
+	sub_bytes(q);
+	inv_affine(q);
+}
+
+/*
+ * In the bit sliced representation, byte r of each 32-bit word holds
+ * row r of the state, with two bits per column. Rotating a row by one
+ * column is therefore a 2-bit rotation within the byte.
+ */
+#define SR_RIGHT	((u8x16){ 0, 2, 4, 6, 0, 2, 4, 6, 0, 2, 4, 6, 0, 2, 4, 6 })
+#define SR_LEFT		((u8x16){ 0, 6, 4, 2, 0, 6, 4, 2, 0, 6, 4, 2, 0, 6, 4, 2 })
+
+static inline void shift_rows(u32x4 q[8])
+{
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		u8x16 x = (u8x16)q[i];
+
+		q[i] = (u32x4)((x >> SR_RIGHT) | (x << SR_LEFT));
+	}
+}
+
+static inline void inv_shift_rows(u32x4 q[8])
+{
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		u8x16 x = (u8x16)q[i];
+
+		q[i] = (u32x4)((x >> SR_LEFT) | (x << SR_RIGHT));
+	}
+}
+
+static inline u32x4 rotr8(u32x4 x)
+{
+	return (x >> SPLAT(8)) | (x << SPLAT(24));
+}
+
+static inline u32x4 rotr16(u32x4 x)
+{
+	return (x >> SPLAT(16)) | (x << SPLAT(16));
+}
+
+static inline void mix_columns(u32x4 q[8])
+{
+	u32x4 q0, q1, q2, q3, q4, q5, q6, q7;
+	u32x4 r0, r1, r2, r3, r4, r5, r6, r7;
+
+	q0 = q[0]; q1 = q[1]; q2 = q[2]; q3 = q[3];
+	q4 = q[4]; q5 = q[5]; q6 = q[6]; q7 = q[7];
+	r0 = rotr8(q0); r1 = rotr8(q1); r2 = rotr8(q2); r3 = rotr8(q3);
+	r4 = rotr8(q4); r5 = rotr8(q5); r6 = rotr8(q6); r7 = rotr8(q7);
+
+	q[0] = q7 ^ r7 ^ r0 ^ rotr16(q0 ^ r0);
+	q[1] = q0 ^ r0 ^ q7 ^ r7 ^ r1 ^ rotr16(q1 ^ r1);
+	q[2] = q1 ^ r1 ^ r2 ^ rotr16(q2 ^ r2);
+	q[3] = q2 ^ r2 ^ q7 ^ r7 ^ r3 ^ rotr16(q3 ^ r3);
+	q[4] = q3 ^ r3 ^ q7 ^ r7 ^ r4 ^ rotr16(q4 ^ r4);
+	q[5] = q4 ^ r4 ^ r5 ^ rotr16(q5 ^ r5);
+	q[6] = q5 ^ r5 ^ r6 ^ rotr16(q6 ^ r6);
+	q[7] = q6 ^ r6 ^ r7 ^ rotr16(q7 ^ r7);
+}
+
+/*
+ * InvMixColumns is MixColumns preceded by multiplying every column with
+ * { 05 00 04 00 }, i.e. a_r ^= 04 * (a_r ^ a_r+2).
+ */
+static inline void inv_mix_columns(u32x4 q[8])
+{
+	u32x4 t[8], u;
+	int i;
+
+	for (i = 0; i < 8; i++)
+		t[i] = q[i] ^ rotr16(q[i]);
+
+	/* times 04: two doublings, each reducing by 0x1b */
+	for (i = 0; i < 2; i++) {
+		u = t[7];
+		t[7] = t[6];
+		t[6] = t[5];
+		t[5] = t[4];
+		t[4] = t[3] ^ u;
+		t[3] = t[2] ^ u;
+		t[2] = t[1];
+		t[1] = t[0] ^ u;
+		t[0] = u;
+	}
+
+	for (i = 0; i < 8; i++)
+		q[i] ^= t[i];
+	mix_columns(q);
+}
+
+static void aesbs_encrypt8(const struct aesbs_key *key, u32x4 q[8])
+{
+	int i;
+
+	add_round_key(q, key->rk);
+	for (i = 1; i < key->rounds; i++) {
+		sub_bytes(q);
+		shift_rows(q);
+		mix_columns(q);
+		add_round_key(q, key->rk + 8 * i);
+	}
+	sub_bytes(q);
+	shift_rows(q);
+	add_round_key(q, key->rk + 8 * key->rounds);
+}
+
+static void aesbs_decrypt8(const struct aesbs_key *key, u32x4 q[8])
+{
+	int i;
+
+	add_round_key(q, key->rk + 8 * key->rounds);
+	for (i = key->rounds - 1; i > 0; i--) {
+		inv_shift_rows(q);
+		inv_sub_bytes(q);
+		add_round_key(q, key->rk + 8 * i);
+		inv_mix_columns(q);
+	}
+	inv_shift_rows(q);
+	inv_sub_bytes(q);
+	add_round_key(q, key->rk);
+}
+
+void aesbs_ecb_encrypt_neon(u8 *out, const u8 *in, unsigned int blocks,
+			    const struct aesbs_key *key)
+{
+	u32x4 q[8];
+
+	for (; blocks; blocks -= AESBS_BLOCKS) {
+		load_blocks(q, in);
+		aesbs_encrypt8(key, q);
+		store_blocks(out, q);
+		in += AESBS_BLOCK_BYTES;
+		out += AESBS_BLOCK_BYTES;
+	}
+}
+
+void aesbs_ecb_decrypt_neon(u8 *out, const u8 *in, unsigned int blocks,
+			    const struct aesbs_key *key)
+{
+	u32x4 q[8];
+
+	for (; blocks; blocks -= AESBS_BLOCKS) {
+		load_blocks(q, in);
+		aesbs_decrypt8(key, q);
+		store_blocks(out, q);
+		in += AESBS_BLOCK_BYTES;
+		out += AESBS_BLOCK_BYTES;
+	}
+}
+
+void aesbs_cbc_decrypt_neon(u8 *out, const u8 *in, unsigned int blocks,
+			    const struct aesbs_key *key, u8 *iv)
+{
+	u8 buf[AES_BLOCK_SIZE + AESBS_BLOCK_BYTES];
+	u32x4 q[8];
+
+	memcpy(buf, iv, AES_BLOCK_SIZE);
+	for (; blocks; blocks -= AESBS_BLOCKS) {
+		/* keep the ciphertext around, we may be decrypting in place */
+		memcpy(buf + AES_BLOCK_SIZE, in, AESBS_BLOCK_BYTES);
+		load_blocks(q, in);
+		aesbs_decrypt8(key, q);
+		store_blocks(out, q);
+		crypto_xor(out, buf, AESBS_BLOCK_BYTES);
+		memcpy(buf, buf + AESBS_BLOCK_BYTES, AES_BLOCK_SIZE);
+		in += AESBS_BLOCK_BYTES;
+		out += AESBS_BLOCK_BYTES;
+	}
+	memcpy(iv, buf, AES_BLOCK_SIZE);
+}
+
+void aesbs_ctr_encrypt_neon(u8 *out, const u8 *in, unsigned int blocks,
+			    const struct aesbs_key *key, u8 *ctr)
+{
+	u8 ks[AESBS_BLOCK_BYTES];
+	u32x4 q[8];
+	int i;
+
+	for (; blocks; blocks -= AESBS_BLOCKS) {
+		for (i = 0; i < AESBS_BLOCKS; i++) {
+			memcpy(ks + i * AES_BLOCK_SIZE, ctr, AES_BLOCK_SIZE);
+			crypto_inc(ctr, AES_BLOCK_SIZE);
+		}
+		load_blocks(q, ks);
+		aesbs_encrypt8(key, q);
+		store_blocks(ks, q);
+		if (out != in)
+			memcpy(out, in, AESBS_BLOCK_BYTES);
+		crypto_xor(out, ks, AESBS_BLOCK_BYTES);
+		in += AESBS_BLOCK_BYTES;
+		out += AESBS_BLOCK_BYTES;
+	}
+}
+
+/* Multiply the tweak by x in GF(2^128), as in IEEE 1619 */
+static inline void xts_next_tweak(u8 *dst, const u8 *src)
+{
+	u64 lo = get_unaligned_le64(src), hi = get_unaligned_le64(src + 8);
+	u64 carry = -(hi >> 63) & 0x87;
+
+	put_unaligned_le64((hi << 1) | (lo >> 63), dst + 8);
+	put_unaligned_le64((lo << 1) ^ carry, dst);
+}
+
+static void aesbs_xts_crypt(u8 *out, const u8 *in, unsigned int blocks,
+			    const struct aesbs_key *key, u8 *tweak,
+			    void (*fn)(const struct aesbs_key *, u32x4 *))
+{
+	u8 t[AESBS_BLOCK_BYTES], buf[AESBS_BLOCK_BYTES];
+	u32x4 q[8];
+	int i;
+
+	for (; blocks; blocks -= AESBS_BLOCKS) {
+		memcpy(t, tweak, AES_BLOCK_SIZE);
+		for (i = 1; i < AESBS_BLOCKS; i++)
+			xts_next_tweak(t + i * AES_BLOCK_SIZE,
+				       t + (i - 1) * AES_BLOCK_SIZE);
+		xts_next_tweak(tweak, t + AESBS_BLOCK_BYTES - AES_BLOCK_SIZE);
+
+		memcpy(buf, in, AESBS_BLOCK_BYTES);
+		crypto_xor(buf, t, AESBS_BLOCK_BYTES);
+		load_blocks(q, buf);
+		fn(key, q);
+		store_blocks(out, q);
+		crypto_xor(out, t, AESBS_BLOCK_BYTES);
+		in += AESBS_BLOCK_BYTES;
+		out += AESBS_BLOCK_BYTES;
+	}
+}
+
+void aesbs_xts_encrypt_neon(u8 *out, const u8 *in, unsigned int blocks,
+			    const struct aesbs_key *key, u8 *tweak)
+{
+	aesbs_xts_crypt(out, in, blocks, key, tweak, aesbs_encrypt8);
+}
+
+void aesbs_xts_decrypt_neon(u8 *out, const u8 *in, unsigned int blocks,
+			    const struct aesbs_key *key, u8 *tweak)
+{
+	aesbs_xts_crypt(out, in, blocks, key, tweak, aesbs_decrypt8);
+}
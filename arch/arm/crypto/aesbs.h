@@ -0,0 +1,44 @@
+/*
+ * Interface between the bit sliced NEON AES core and its glue code
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+#ifndef __AESBS_H
+#define __AESBS_H
+
+#include <linux/types.h>
+#include "aes_glue.h"
+
+/* The core only ever works on this many blocks at a time */
+#define AESBS_BLOCKS		8
+#define AESBS_BLOCK_BYTES	(AESBS_BLOCKS * AES_BLOCK_SIZE)
+
+/*
+ * Round keys in bit sliced form: eight words per round, each replicated
+ * across the four 32-bit lanes of a NEON register.
+ */
+struct aesbs_key {
+	u32	rk[(AES_MAXNR + 1) * 8][4] __aligned(16);
+	int	rounds;
+};
+
+/*
+ * All of the below take a multiple of AESBS_BLOCKS blocks, and must be
+ * called between kernel_neon_begin() and kernel_neon_end().
+ */
+void aesbs_ecb_encrypt_neon(u8 *out, const u8 *in, unsigned int blocks,
+			    const struct aesbs_key *key);
+void aesbs_ecb_decrypt_neon(u8 *out, const u8 *in, unsigned int blocks,
+			    const struct aesbs_key *key);
+void aesbs_cbc_decrypt_neon(u8 *out, const u8 *in, unsigned int blocks,
+			    const struct aesbs_key *key, u8 *iv);
+void aesbs_ctr_encrypt_neon(u8 *out, const u8 *in, unsigned int blocks,
+			    const struct aesbs_key *key, u8 *ctr);
+void aesbs_xts_encrypt_neon(u8 *out, const u8 *in, unsigned int blocks,
+			    const struct aesbs_key *key, u8 *tweak);
+void aesbs_xts_decrypt_neon(u8 *out, const u8 *in, unsigned int blocks,
+			    const struct aesbs_key *key, u8 *tweak);
+
+#endif
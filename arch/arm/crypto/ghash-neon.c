@@ -0,0 +1,138 @@
+/*
+ * linux/arch/arm/crypto/ghash-neon.c
+ *
+ * GHASH block function using the NEON vmull.p8 instruction.
+ *
+ * NEON on ARMv7 only offers an 8x8 -> 16 bit polynomial multiply, so a
+ * 64x64 bit carry-less product is assembled from nine of those and the
+ * 128x128 bit product from three 64x64 bit ones (Karatsuba). The result
+ * is reduced modulo the GHASH polynomial in its bit reflected form, see
+ * "Intel Carry-Less Multiplication Instruction and its Usage for Computing
+ * the GCM Mode", S. Gueron and M. Kounavis.
+ *
+ * This unit uses NEON intrinsics, so it must not include kernel headers,
+ * and must be built with '-ffreestanding -mfloat-abi=softfp -mfpu=neon'.
+ * It may only be called between kernel_neon_begin() and kernel_neon_end().
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <arm_neon.h>
+
+void ghash_neon_update(uint8_t *dg, const uint8_t *src, unsigned int blocks,
+		       const uint64_t *k);
+
+#define PMULL8(a, b)	vreinterpretq_u64_p16(vmull_p8(a, b))
+
+/*
+ * Partial products of bytes i and i + n (mod 8) come out of vmull.p8 in
+ * lane i. Those that wrapped around, in the top n lanes, belong 64 bits
+ * lower than where shifting the whole vector by n bytes would put them.
+ */
+static inline uint64x2_t pmull_fold(uint64x2_t t, uint64_t keep)
+{
+	uint64x1_t lo = vget_low_u64(t), hi = vget_high_u64(t);
+
+	lo = veor_u64(lo, vand_u64(hi, vcreate_u64(~keep)));
+	hi = vand_u64(hi, vcreate_u64(keep));
+	return vcombine_u64(lo, hi);
+}
+
+#define SHL_BYTES(t, n)							\
+	vreinterpretq_u64_u8(vextq_u8(vreinterpretq_u8_u64(t),		\
+				      vreinterpretq_u8_u64(t), 16 - (n)))
+
+/* 64x64 -> 128 bit carry-less multiplication */
+static inline uint64x2_t pmull64(uint64x1_t x, uint64x1_t y)
+{
+	poly8x8_t a = vreinterpret_p8_u64(x), b = vreinterpret_p8_u64(y);
+	uint64x2_t d, l, m, n, k;
+
+	d = PMULL8(a, b);
+	l = veorq_u64(PMULL8(a, vext_p8(b, b, 1)),
+		      PMULL8(vext_p8(a, a, 1), b));
+	m = veorq_u64(PMULL8(a, vext_p8(b, b, 2)),
+		      PMULL8(vext_p8(a, a, 2), b));
+	n = veorq_u64(PMULL8(a, vext_p8(b, b, 3)),
+		      PMULL8(vext_p8(a, a, 3), b));
+	k = PMULL8(a, vext_p8(b, b, 4));
+
+	l = SHL_BYTES(pmull_fold(l, 0x0000ffffffffffffULL), 1);
+	m = SHL_BYTES(pmull_fold(m, 0x00000000ffffffffULL), 2);
+	n = SHL_BYTES(pmull_fold(n, 0x000000000000ffffULL), 3);
+	k = SHL_BYTES(pmull_fold(k, 0), 4);
+
+	return veorq_u64(veorq_u64(d, l), veorq_u64(veorq_u64(m, n), k));
+}
+
+/*
+ * The digest is kept as a big endian 128-bit integer, least significant
+ * half in lane 0, which puts the GHASH bit order in reverse.
+ */
+static inline uint64x2_t load_be128(const uint8_t *p)
+{
+	uint64x2_t t = vreinterpretq_u64_u8(vrev64q_u8(vld1q_u8(p)));
+
+	return vextq_u64(t, t, 1);
+}
+
+static inline void store_be128(uint8_t *p, uint64x2_t x)
+{
+	x = vextq_u64(x, x, 1);
+	vst1q_u8(p, vrev64q_u8(vreinterpretq_u8_u64(x)));
+}
+
+static inline uint64x2_t ghash_mul(uint64x2_t x, uint64x2_t h, uint64x1_t hk)
+{
+	const uint64x2_t zero = vdupq_n_u64(0);
+	uint64x1_t xl = vget_low_u64(x), xh = vget_high_u64(x);
+	uint64x2_t lo, hi, mid, t, u;
+
+	/* Karatsuba: 256-bit product in hi:lo */
+	lo = pmull64(xl, vget_low_u64(h));
+	hi = pmull64(xh, vget_high_u64(h));
+	mid = veorq_u64(pmull64(veor_u64(xl, xh), hk), veorq_u64(lo, hi));
+	lo = veorq_u64(lo, vextq_u64(zero, mid, 1));
+	hi = veorq_u64(hi, vextq_u64(mid, zero, 1));
+
+	/* the product of two reflected values is off by one bit */
+	hi = vorrq_u64(vshlq_n_u64(hi, 1),
+		       vextq_u64(vshrq_n_u64(lo, 63), vshrq_n_u64(hi, 63), 1));
+	lo = vorrq_u64(vshlq_n_u64(lo, 1),
+		       vextq_u64(zero, vshrq_n_u64(lo, 63), 1));
+
+	/* reduce modulo x^128 + x^7 + x^2 + x + 1, reflected */
+	t = veorq_u64(veorq_u64(vshlq_n_u64(lo, 63), vshlq_n_u64(lo, 62)),
+		      vshlq_n_u64(lo, 57));
+	t = veorq_u64(lo, vextq_u64(zero, t, 1));
+
+	u = vextq_u64(t, zero, 1);
+	hi = veorq_u64(hi, t);
+	hi = veorq_u64(hi, vorrq_u64(vshrq_n_u64(t, 1), vshlq_n_u64(u, 63)));
+	hi = veorq_u64(hi, vorrq_u64(vshrq_n_u64(t, 2), vshlq_n_u64(u, 62)));
+	hi = veorq_u64(hi, vorrq_u64(vshrq_n_u64(t, 7), vshlq_n_u64(u, 57)));
+
+	return hi;
+}
+
+/*
+ * Fold 'blocks' 16-byte blocks of 'src' into the digest 'dg'. 'k' holds
+ * the hash key H as a big endian 128-bit integer, least significant
+ * 64 bits first.
+ */
+void ghash_neon_update(uint8_t *dg, const uint8_t *src, unsigned int blocks,
+		       const uint64_t *k)
+{
+	uint64x2_t x = load_be128(dg);
+	uint64x2_t h = vld1q_u64(k);
+	uint64x1_t hk = veor_u64(vget_low_u64(h), vget_high_u64(h));
+
+	while (blocks--) {
+		x = veorq_u64(x, load_be128(src));
+		x = ghash_mul(x, h, hk);
+		src += 16;
+	}
+	store_be128(dg, x);
+}
@@ -0,0 +1,169 @@
+/*
+ * linux/arch/arm/crypto/sha256-neon.c
+ *
+ * SHA-256 block function with the message schedule computed by NEON.
+ *
+ * The compression rounds of a block depend on each other and stay in
+ * ARM registers, but the message schedules of consecutive blocks are
+ * independent: they are expanded four at a time, one block per 32-bit
+ * lane, with the round constants already added. This takes about a
+ * quarter of the integer work off each block, and the NEON unit runs
+ * decoupled from the integer pipeline on the Cortex-A8.
+ *
+ * The code relies on the GCC vector extensions, and must be built with
+ * '-mfloat-abi=softfp -mfpu=neon'. It may only be called between
+ * kernel_neon_begin() and kernel_neon_end().
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/types.h>
+#include <linux/kernel.h>
+#include <linux/bitops.h>
+#include <linux/string.h>
+#include <crypto/sha.h>
+#include <asm/unaligned.h>
+
+#ifndef __ARM_NEON__
+#error You should compile this file with '-mfloat-abi=softfp -mfpu=neon'
+#endif
+
+#define SHA256_LANES	4
+
+typedef u32 u32x4 __attribute__((vector_size(16)));
+
+#define SPLAT(x)	((u32x4){ (x), (x), (x), (x) })
+
+void sha256_neon_blocks(u32 *state, const u8 *data, unsigned int blocks);
+
+static const u32 sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+	0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+	0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+	0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+	0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+	0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static inline u32x4 ror(u32x4 x, int n)
+{
+	return (x >> SPLAT(n)) | (x << SPLAT(32 - n));
+}
+
+static inline u32x4 s0(u32x4 x)
+{
+	return ror(x, 7) ^ ror(x, 18) ^ (x >> SPLAT(3));
+}
+
+static inline u32x4 s1(u32x4 x)
+{
+	return ror(x, 17) ^ ror(x, 19) ^ (x >> SPLAT(10));
+}
+
+/* W[t] + K[t] for the blocks at src[0..3], block i in lane i */
+static void sha256_schedule(u32 wk[64][SHA256_LANES],
+			    const u8 *const src[SHA256_LANES])
+{
+	union {
+		u32x4	v;
+		u32	w[SHA256_LANES];
+	} t;
+	u32x4 w[16];
+	int i, j;
+
+	for (i = 0; i < 16; i++) {
+		for (j = 0; j < SHA256_LANES; j++)
+			t.w[j] = get_unaligned_be32(src[j] + 4 * i);
+		w[i] = t.v;
+		*(u32x4 *)wk[i] = w[i] + SPLAT(sha256_k[i]);
+	}
+
+	for (i = 16; i < 64; i++) {
+		w[i & 15] += s1(w[(i - 2) & 15]) + w[(i - 7) & 15] +
+			     s0(w[(i - 15) & 15]);
+		*(u32x4 *)wk[i] = w[i & 15] + SPLAT(sha256_k[i]);
+	}
+}
+
+static inline u32 Ch(u32 x, u32 y, u32 z)
+{
+	return z ^ (x & (y ^ z));
+}
+
+static inline u32 Maj(u32 x, u32 y, u32 z)
+{
+	return (x & y) | (z & (x | y));
+}
+
+#define e0(x)	(ror32(x, 2) ^ ror32(x, 13) ^ ror32(x, 22))
+#define e1(x)	(ror32(x, 6) ^ ror32(x, 11) ^ ror32(x, 25))
+
+#define ROUND(a, b, c, d, e, f, g, h, i)				\
+	do {								\
+		u32 t1 = h + e1(e) + Ch(e, f, g) + wk[i][lane];		\
+		d += t1;						\
+		h = t1 + e0(a) + Maj(a, b, c);				\
+	} while (0)
+
+static void sha256_rounds(u32 *state, u32 wk[64][SHA256_LANES], int lane)
+{
+	u32 a = state[0], b = state[1], c = state[2], d = state[3];
+	u32 e = state[4], f = state[5], g = state[6], h = state[7];
+	int i;
+
+	for (i = 0; i < 64; i += 8) {
+		ROUND(a, b, c, d, e, f, g, h, i);
+		ROUND(h, a, b, c, d, e, f, g, i + 1);
+		ROUND(g, h, a, b, c, d, e, f, i + 2);
+		ROUND(f, g, h, a, b, c, d, e, i + 3);
+		ROUND(e, f, g, h, a, b, c, d, i + 4);
+		ROUND(d, e, f, g, h, a, b, c, i + 5);
+		ROUND(c, d, e, f, g, h, a, b, i + 6);
+		ROUND(b, c, d, e, f, g, h, a, i + 7);
+	}
+
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+	state[5] += f;
+	state[6] += g;
+	state[7] += h;
+}
+
+void sha256_neon_blocks(u32 *state, const u8 *data, unsigned int blocks)
+{
+	u32 wk[64][SHA256_LANES] __aligned(16);
+	const u8 *src[SHA256_LANES];
+	unsigned int i, n;
+
+	while (blocks) {
+		n = min_t(unsigned int, blocks, SHA256_LANES);
+
+		/* spare lanes just redo the first block */
+		for (i = 0; i < SHA256_LANES; i++)
+			src[i] = data + (i < n ? i : 0) * SHA256_BLOCK_SIZE;
+		sha256_schedule(wk, src);
+
+		for (i = 0; i < n; i++)
+			sha256_rounds(state, wk, i);
+
+		data += n * SHA256_BLOCK_SIZE;
+		blocks -= n;
+	}
+
+	memset(wk, 0, sizeof(wk));
+}
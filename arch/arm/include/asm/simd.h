@@ -0,0 +1,22 @@
+#ifndef __ASM_ARM_SIMD_H
+#define __ASM_ARM_SIMD_H
+
+#include <linux/hardirq.h>
+
+/*
+ * may_use_simd - whether it is allowable at this time to issue SIMD
+ *                instructions or access the SIMD register file
+ *
+ * kernel_neon_begin() may not be called from interrupt context, since the
+ * NEON register file of the interrupted context is not preserved.
+ */
+static inline int may_use_simd(void)
+{
+#ifdef CONFIG_KERNEL_MODE_NEON
+	return !in_interrupt();
+#else
+	return 0;
+#endif
+}
+
+#endif /* __ASM_ARM_SIMD_H */
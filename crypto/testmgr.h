@@ -41,7 +41,7 @@ struct hash_testvec {
 	char *plaintext;
 	char *digest;
 	unsigned char tap[MAX_TAP];
-	unsigned char psize;
+	unsigned short psize;
 	unsigned char np;
 	unsigned char ksize;
 };
@@ -528,7 +528,7 @@ static struct hash_testvec sha224_tv_template[] = {
 /*
  * SHA256 test vectors from from NIST
  */
-#define SHA256_TEST_VECTORS	2
+#define SHA256_TEST_VECTORS	4
 
 static struct hash_testvec sha256_tv_template[] = {
 	{
@@ -547,6 +547,146 @@ static struct hash_testvec sha256_tv_template[] = {
 			  "\xf6\xec\xed\xd4\x19\xdb\x06\xc1",
 		.np	= 2,
 		.tap	= { 28, 28 }
+	}, {
+		.plaintext = "\x07\x24\x41\x5e\x7b\x98\xb5\xd2"
+			     "\xee\x0d\x28\x47\x62\x81\x9c\xbb"
+			     "\xd5\xf6\x13\x2c\x49\x6a\x87\xa0"
+			     "\xbc\xdf\xfa\x15\x30\x53\x6e\x89"
+			     "\xa3\xc0\xe5\xfa\x1f\x3c\x51\x76"
+			     "\x8a\xa9\xcc\xe3\x06\x25\x38\x5f"
+			     "\x71\x92\xb7\xc8\xed\x0e\x23\x44"
+			     "\x58\x7b\x9e\xb1\xd4\xf7\x0a\x2d"
+			     "\x4f\x6c\x89\x96\xb3\xd0\xfd\x1a"
+			     "\x26\x45\x60\x8f\xaa\xc9\xd4\xf3"
+			     "\x1d\x3e\x5b\x64\x81\xa2\xcf\xe8"
+			     "\xf4\x17\x32\x5d\x78\x9b\xa6\xc1"
+			     "\xeb\x08\x2d\x32\x57\x74\x99\xbe"
+			     "\xc2\xe1\x04\x2b\x4e\x6d\x70\x97"
+			     "\xb9\xda\xff\x00\x25\x46\x6b\x8c"
+			     "\x90\xb3\xd6\xf9\x1c\x3f\x42\x65"
+			     "\x97\xb4\xd1\xce\xeb\x08\x25\x42"
+			     "\x7e\x9d\xb8\xd7\xf2\x11\x0c\x2b"
+			     "\x45\x66\x83\xbc\xd9\xfa\x17\x30"
+			     "\x2c\x4f\x6a\x85\xa0\xc3\xfe\x19"
+			     "\x33\x50\x75\x6a\x8f\xac\xc1\xe6"
+			     "\x1a\x39\x5c\x73\x96\xb5\xa8\xcf"
+			     "\xe1\x02\x27\x58\x7d\x9e\xb3\xd4"
+			     "\xc8\xeb\x0e\x21\x44\x67\x9a\xbd"
+			     "\xdf\xfc\x19\x06\x23\x40\x6d\x8a"
+			     "\xb6\xd5\xf0\x1f\x3a\x59\x44\x63"
+			     "\x8d\xae\xcb\xf4\x11\x32\x5f\x78"
+			     "\x64\x87\xa2\xcd\xe8\x0b\x36\x51"
+			     "\x7b\x98\xbd\xa2\xc7\xe4\x09\x2e"
+			     "\x52\x71\x94\xbb\xde\xfd\xe0\x07"
+			     "\x29\x4a\x6f\x90\xb5\xd6\xfb\x1c"
+			     "\x00\x23\x46\x69\x8c\xaf\xd2\xf5"
+			     "\x27\x04\x61\x7e\x5b\xb8\x95\xf2"
+			     "\xce\x2d\x08\x67\x42\xa1\xbc\x9b"
+			     "\xf5\xd6\x33\x0c\x69\x4a\xa7\x80"
+			     "\x9c\xff\xda\x35\x10\x73\x4e\xa9"
+			     "\x83\xe0\xc5\xda\x3f\x1c\x71\x56"
+			     "\xaa\x89\xec\xc3\x26\x05\x18\x7f"
+			     "\x51\xb2\x97\xe8\xcd\x2e\x03\x64"
+			     "\x78\x5b\xbe\x91\xf4\xd7\x2a\x0d"
+			     "\x6f\x4c\xa9\xb6\x93\xf0\xdd\x3a"
+			     "\x06\x65\x40\xaf\x8a\xe9\xf4\xd3"
+			     "\x3d\x1e\x7b\x44\xa1\x82\xef\xc8"
+			     "\xd4\x37\x12\x7d\x58\xbb\x86\xe1"
+			     "\xcb\x28\x0d\x12\x77\x54\xb9\x9e"
+			     "\xe2\xc1\x24\x0b\x6e\x4d\x50\xb7"
+			     "\x99\xfa\xdf\x20\x05\x66\x4b\xac"
+			     "\xb0\x93\xf6\xd9\x3c\x1f\x62\x45"
+			     "\xb7\x94\xf1\xee\xcb\x28\x05\x62"
+			     "\x5e\xbd\x98\xf7\xd2\x31\x2c\x0b"
+			     "\x65\x46\xa3\x9c\xf9\xda\x37\x10"
+			     "\x0c\x6f\x4a\xa5\x80\xe3\xde\x39"
+			     "\x13\x70\x55\x4a\xaf\x8c\xe1\xc6"
+			     "\x3a\x19\x7c\x53\xb6\x95\x88\xef"
+			     "\xc1\x22\x07\x78\x5d\xbe\x93\xf4"
+			     "\xe8\xcb\x2e\x01\x64\x47\xba\x9d"
+			     "\xff\xdc\x39\x26\x03\x60\x4d\xaa"
+			     "\x96\xf5\xd0\x3f\x1a\x79\x64\x43"
+			     "\xad\x8e\xeb\xd4\x31\x12\x7f\x58"
+			     "\x44\xa7\x82\xed\xc8\x2b\x16\x71"
+			     "\x5b\xb8\x9d\x82\xe7\xc4\x29\x0e"
+			     "\x72\x51\xb4\x9b\xfe\xdd\xc0\x27"
+			     "\x09\x6a\x4f\xb0",
+		.psize	= 500,
+		.digest	= "\x23\x46\xc9\xf1\xdb\xd1\xf7\x1c"
+			  "\x9b\x86\xfc\x1d\x57\x61\xb0\xd0"
+			  "\x01\x15\x9f\x79\x6d\x29\xe9\x19"
+			  "\x72\xa8\x09\xbe\xa8\x98\x32\x8a",
+	}, {
+		.plaintext = "\x07\x24\x41\x5e\x7b\x98\xb5\xd2"
+			     "\xee\x0d\x28\x47\x62\x81\x9c\xbb"
+			     "\xd5\xf6\x13\x2c\x49\x6a\x87\xa0"
+			     "\xbc\xdf\xfa\x15\x30\x53\x6e\x89"
+			     "\xa3\xc0\xe5\xfa\x1f\x3c\x51\x76"
+			     "\x8a\xa9\xcc\xe3\x06\x25\x38\x5f"
+			     "\x71\x92\xb7\xc8\xed\x0e\x23\x44"
+			     "\x58\x7b\x9e\xb1\xd4\xf7\x0a\x2d"
+			     "\x4f\x6c\x89\x96\xb3\xd0\xfd\x1a"
+			     "\x26\x45\x60\x8f\xaa\xc9\xd4\xf3"
+			     "\x1d\x3e\x5b\x64\x81\xa2\xcf\xe8"
+			     "\xf4\x17\x32\x5d\x78\x9b\xa6\xc1"
+			     "\xeb\x08\x2d\x32\x57\x74\x99\xbe"
+			     "\xc2\xe1\x04\x2b\x4e\x6d\x70\x97"
+			     "\xb9\xda\xff\x00\x25\x46\x6b\x8c"
+			     "\x90\xb3\xd6\xf9\x1c\x3f\x42\x65"
+			     "\x97\xb4\xd1\xce\xeb\x08\x25\x42"
+			     "\x7e\x9d\xb8\xd7\xf2\x11\x0c\x2b"
+			     "\x45\x66\x83\xbc\xd9\xfa\x17\x30"
+			     "\x2c\x4f\x6a\x85\xa0\xc3\xfe\x19"
+			     "\x33\x50\x75\x6a\x8f\xac\xc1\xe6"
+			     "\x1a\x39\x5c\x73\x96\xb5\xa8\xcf"
+			     "\xe1\x02\x27\x58\x7d\x9e\xb3\xd4"
+			     "\xc8\xeb\x0e\x21\x44\x67\x9a\xbd"
+			     "\xdf\xfc\x19\x06\x23\x40\x6d\x8a"
+			     "\xb6\xd5\xf0\x1f\x3a\x59\x44\x63"
+			     "\x8d\xae\xcb\xf4\x11\x32\x5f\x78"
+			     "\x64\x87\xa2\xcd\xe8\x0b\x36\x51"
+			     "\x7b\x98\xbd\xa2\xc7\xe4\x09\x2e"
+			     "\x52\x71\x94\xbb\xde\xfd\xe0\x07"
+			     "\x29\x4a\x6f\x90\xb5\xd6\xfb\x1c"
+			     "\x00\x23\x46\x69\x8c\xaf\xd2\xf5"
+			     "\x27\x04\x61\x7e\x5b\xb8\x95\xf2"
+			     "\xce\x2d\x08\x67\x42\xa1\xbc\x9b"
+			     "\xf5\xd6\x33\x0c\x69\x4a\xa7\x80"
+			     "\x9c\xff\xda\x35\x10\x73\x4e\xa9"
+			     "\x83\xe0\xc5\xda\x3f\x1c\x71\x56"
+			     "\xaa\x89\xec\xc3\x26\x05\x18\x7f"
+			     "\x51\xb2\x97\xe8\xcd\x2e\x03\x64"
+			     "\x78\x5b\xbe\x91\xf4\xd7\x2a\x0d"
+			     "\x6f\x4c\xa9\xb6\x93\xf0\xdd\x3a"
+			     "\x06\x65\x40\xaf\x8a\xe9\xf4\xd3"
+			     "\x3d\x1e\x7b\x44\xa1\x82\xef\xc8"
+			     "\xd4\x37\x12\x7d\x58\xbb\x86\xe1"
+			     "\xcb\x28\x0d\x12\x77\x54\xb9\x9e"
+			     "\xe2\xc1\x24\x0b\x6e\x4d\x50\xb7"
+			     "\x99\xfa\xdf\x20\x05\x66\x4b\xac"
+			     "\xb0\x93\xf6\xd9\x3c\x1f\x62\x45"
+			     "\xb7\x94\xf1\xee\xcb\x28\x05\x62"
+			     "\x5e\xbd\x98\xf7\xd2\x31\x2c\x0b"
+			     "\x65\x46\xa3\x9c\xf9\xda\x37\x10"
+			     "\x0c\x6f\x4a\xa5\x80\xe3\xde\x39"
+			     "\x13\x70\x55\x4a\xaf\x8c\xe1\xc6"
+			     "\x3a\x19\x7c\x53\xb6\x95\x88\xef"
+			     "\xc1\x22\x07\x78\x5d\xbe\x93\xf4"
+			     "\xe8\xcb\x2e\x01\x64\x47\xba\x9d"
+			     "\xff\xdc\x39\x26\x03\x60\x4d\xaa"
+			     "\x96\xf5\xd0\x3f\x1a\x79\x64\x43"
+			     "\xad\x8e\xeb\xd4\x31\x12\x7f\x58"
+			     "\x44\xa7\x82\xed\xc8\x2b\x16\x71"
+			     "\x5b\xb8\x9d\x82\xe7\xc4\x29\x0e"
+			     "\x72\x51\xb4\x9b\xfe\xdd\xc0\x27"
+			     "\x09\x6a\x4f\xb0",
+		.psize	= 500,
+		.digest	= "\x23\x46\xc9\xf1\xdb\xd1\xf7\x1c"
+			  "\x9b\x86\xfc\x1d\x57\x61\xb0\xd0"
+			  "\x01\x15\x9f\x79\x6d\x29\xe9\x19"
+			  "\x72\xa8\x09\xbe\xa8\x98\x32\x8a",
+		.np	= 3,
+		.tap	= { 1, 250, 249 }
 	},
 };
 
@@ -1040,7 +1180,7 @@ static struct hash_testvec tgr128_tv_template[] = {
 	},
 };
 
-#define GHASH_TEST_VECTORS 1
+#define GHASH_TEST_VECTORS 3
 
 static struct hash_testvec ghash_tv_template[] =
 {
@@ -1052,6 +1192,70 @@ static struct hash_testvec ghash_tv_template[] =
 		.psize	= 16,
 		.digest	= "\xda\x53\xeb\x0a\xd2\xc5\x5b\xb6"
 			  "\x4f\xc4\x80\x2c\xc3\xfe\xda\x60",
+	}, {
+		.key	= "\xdf\xa6\xbf\x4d\xed\x81\xdb\x03\xff\xca\xff\x95\xf8\x30\xf0\x61",
+		.ksize	= 16,
+		.plaintext = "\x0b\x8e\x11\x94\x16\x9b\x1c\xa1"
+			     "\x21\xa4\x2b\xae\x2c\xb1\x36\xbb"
+			     "\x3f\xba\x45\xc0\x42\xcf\x48\xd5"
+			     "\x55\xd0\x5f\xda\x58\xe5\x62\xef"
+			     "\x63\xe6\x79\xfc\x7e\xf3\x74\x09"
+			     "\x89\x0c\x83\x06\x84\x19\x9e\x13"
+			     "\x97\x12\xad\x28\xaa\x27\xa0\x3d"
+			     "\xbd\x38\xb7\x32\xb0\x4d\xca\x47"
+			     "\xdb\x5e\xc1\x44\xc6\x4b\xcc\x71"
+			     "\xf1\x74\xfb\x7e\xfc\x61\xe6\x6b"
+			     "\xef\x6a\x15\x90\x12\x9f\x18\x85"
+			     "\x05\x80\x0f\x8a\x08\xb5\x32\xbf"
+			     "\x33\xb6\x29\xac\x2e\xa3\x24\xd9"
+			     "\x59\xdc\x53\xd6\x54\xc9\x4e\xc3"
+			     "\x47\xc2\x7d\xf8\x7a\xf7\x70\xed"
+			     "\x6d\xe8\x67\xe2\x60\x1d\x9a\x17"
+			     "\xab\x2e\xb1\x34\xb6\x3b\xbc\x01"
+			     "\x81\x04\x8b\x0e\x8c\x11\x96\x1b"
+			     "\x9f\x1a\xe5\x60\xe2\x6f\xe8\x75"
+			     "\xf5\x70\xff\x7a\xf8\x45\xc2\x4f"
+			     "\xc3\x46\xd9\x5c\xde\x53\xd4\xa9"
+			     "\x29\xac\x23\xa6\x24\xb9\x3e\xb3"
+			     "\x37\xb2\x0d\x88\x0a\x87\x00\x9d"
+			     "\x1d\x98\x17\x92\x10\xed\x6a\xe7"
+			     "\x7b\xfe\x61\xe4\x66\xeb\x6c\xd1",
+		.psize	= 200,
+		.digest	= "\xdf\x9f\xa1\x56\x25\x8f\x96\xc4"
+			  "\x6e\x35\xae\x4b\x1e\x30\xdd\x8d",
+	}, {
+		.key	= "\xdf\xa6\xbf\x4d\xed\x81\xdb\x03\xff\xca\xff\x95\xf8\x30\xf0\x61",
+		.ksize	= 16,
+		.plaintext = "\x0b\x8e\x11\x94\x16\x9b\x1c\xa1"
+			     "\x21\xa4\x2b\xae\x2c\xb1\x36\xbb"
+			     "\x3f\xba\x45\xc0\x42\xcf\x48\xd5"
+			     "\x55\xd0\x5f\xda\x58\xe5\x62\xef"
+			     "\x63\xe6\x79\xfc\x7e\xf3\x74\x09"
+			     "\x89\x0c\x83\x06\x84\x19\x9e\x13"
+			     "\x97\x12\xad\x28\xaa\x27\xa0\x3d"
+			     "\xbd\x38\xb7\x32\xb0\x4d\xca\x47"
+			     "\xdb\x5e\xc1\x44\xc6\x4b\xcc\x71"
+			     "\xf1\x74\xfb\x7e\xfc\x61\xe6\x6b"
+			     "\xef\x6a\x15\x90\x12\x9f\x18\x85"
+			     "\x05\x80\x0f\x8a\x08\xb5\x32\xbf"
+			     "\x33\xb6\x29\xac\x2e\xa3\x24\xd9"
+			     "\x59\xdc\x53\xd6\x54\xc9\x4e\xc3"
+			     "\x47\xc2\x7d\xf8\x7a\xf7\x70\xed"
+			     "\x6d\xe8\x67\xe2\x60\x1d\x9a\x17"
+			     "\xab\x2e\xb1\x34\xb6\x3b\xbc\x01"
+			     "\x81\x04\x8b\x0e\x8c\x11\x96\x1b"
+			     "\x9f\x1a\xe5\x60\xe2\x6f\xe8\x75"
+			     "\xf5\x70\xff\x7a\xf8\x45\xc2\x4f"
+			     "\xc3\x46\xd9\x5c\xde\x53\xd4\xa9"
+			     "\x29\xac\x23\xa6\x24\xb9\x3e\xb3"
+			     "\x37\xb2\x0d\x88\x0a\x87\x00\x9d"
+			     "\x1d\x98\x17\x92\x10\xed\x6a\xe7"
+			     "\x7b\xfe\x61\xe4\x66\xeb\x6c\xd1",
+		.psize	= 200,
+		.digest	= "\xdf\x9f\xa1\x56\x25\x8f\x96\xc4"
+			  "\x6e\x35\xae\x4b\x1e\x30\xdd\x8d",
+		.np	= 2,
+		.tap	= { 13, 187 }
 	},
 };
 
@@ -2970,16 +3174,16 @@ static struct cipher_testvec cast6_dec_tv_template[] = {
 /*
  * AES test vectors.
  */
-#define AES_ENC_TEST_VECTORS 3
-#define AES_DEC_TEST_VECTORS 3
-#define AES_CBC_ENC_TEST_VECTORS 4
-#define AES_CBC_DEC_TEST_VECTORS 4
+#define AES_ENC_TEST_VECTORS 4
+#define AES_DEC_TEST_VECTORS 4
+#define AES_CBC_ENC_TEST_VECTORS 5
+#define AES_CBC_DEC_TEST_VECTORS 5
 #define AES_LRW_ENC_TEST_VECTORS 8
 #define AES_LRW_DEC_TEST_VECTORS 8
 #define AES_XTS_ENC_TEST_VECTORS 4
 #define AES_XTS_DEC_TEST_VECTORS 4
-#define AES_CTR_ENC_TEST_VECTORS 3
-#define AES_CTR_DEC_TEST_VECTORS 3
+#define AES_CTR_ENC_TEST_VECTORS 4
+#define AES_CTR_DEC_TEST_VECTORS 4
 #define AES_OFB_ENC_TEST_VECTORS 1
 #define AES_OFB_DEC_TEST_VECTORS 1
 #define AES_CTR_3686_ENC_TEST_VECTORS 7
@@ -3027,6 +3231,48 @@ static struct cipher_testvec aes_enc_tv_template[] = {
 		.result	= "\x8e\xa2\xb7\xca\x51\x67\x45\xbf"
 			  "\xea\xfc\x49\x90\x4b\x49\x60\x89",
 		.rlen	= 16,
+	}, {
+		.key	= "\xb6\x0e\x75\x0f\xc7\xba\x21\xd9"
+			  "\x9c\xae\x30\x4f\x31\x8c\xb1\x00",
+		.klen	= 16,
+		.input	= "\x4f\x2c\x1f\xbd\x82\x1e\xc6\x55"
+			  "\x9e\x95\xc3\xa0\x6c\x69\xe7\x5b"
+			  "\x43\xc8\xd9\x78\x7f\x39\x26\xe3"
+			  "\x8f\xd4\x3b\x90\x65\x59\xcf\xaf"
+			  "\xe6\x2e\xf2\xd7\xec\xb9\x43\xe3"
+			  "\x8c\x47\x77\x50\x97\x9f\x23\x99"
+			  "\x35\x98\xd0\x74\xd0\x9e\xb5\xe9"
+			  "\x21\x24\x19\xac\xd1\xa4\x58\x5f"
+			  "\xd4\xaf\xf6\xba\x8e\x01\x85\x1d"
+			  "\x52\x8a\x3c\x86\x2b\xea\x49\x80"
+			  "\x4e\xef\x5c\xbc\xc0\x4b\x38\xed"
+			  "\xa6\x58\x42\x88\xe7\xec\x0b\xd0"
+			  "\xec\xfc\xc8\x56\x4a\x26\xcb\xcd"
+			  "\x9c\x54\xe8\xed\x6f\xd2\x9f\xe3"
+			  "\x88\x3d\x78\x4d\x9d\x38\x8f\x02"
+			  "\x3d\xe6\xf8\xff\x9a\x7d\xb5\x37"
+			  "\xaf\xae\x98\xb4\x12\xa4\x9c\x57"
+			  "\xc3\xed\x12\x04\x20\x32\xca\x31",
+		.ilen	= 144,
+		.result	= "\x69\xf4\xe3\xaf\x02\x80\xb2\xbc"
+			  "\x77\x0a\xda\x4c\x0c\xb2\xd8\xa9"
+			  "\x01\x9a\x7d\xd0\xb6\xd2\x9c\x7d"
+			  "\x95\x0c\xc5\xb9\x2c\x1d\x1d\xc0"
+			  "\xe4\xf5\x97\x8f\x95\x11\x13\x3c"
+			  "\x64\x86\x7b\xbd\xdb\xab\x15\xe4"
+			  "\x2f\xda\xad\x09\xad\x90\xa2\x62"
+			  "\xa5\x35\xc9\x97\x04\x6b\x20\xb9"
+			  "\x51\x31\x8f\xc2\xb5\x70\x10\x99"
+			  "\x13\x65\xa4\x96\x88\x43\x8c\x81"
+			  "\x31\x30\x4e\x4c\xf4\xe2\xc0\x47"
+			  "\x00\xc9\xb1\x31\xdc\xbb\x36\x0d"
+			  "\xa3\x58\x03\x0a\xbe\x40\x26\x83"
+			  "\x12\x4c\x2a\x31\xe7\x49\xc7\xfc"
+			  "\x1c\x3c\x41\x84\x7c\xc0\x42\x06"
+			  "\xac\xf2\x34\x7a\x6c\x54\x3a\x24"
+			  "\x9c\xc9\xcf\xb8\x7a\x80\x5e\xb0"
+			  "\xf6\x5a\xa2\xbd\x55\x9b\x51\x86",
+		.rlen	= 144,
 	},
 };
 
@@ -3064,6 +3310,48 @@ static struct cipher_testvec aes_dec_tv_template[] = {
 		.result	= "\x00\x11\x22\x33\x44\x55\x66\x77"
 			  "\x88\x99\xaa\xbb\xcc\xdd\xee\xff",
 		.rlen	= 16,
+	}, {
+		.key	= "\xb6\x0e\x75\x0f\xc7\xba\x21\xd9"
+			  "\x9c\xae\x30\x4f\x31\x8c\xb1\x00",
+		.klen	= 16,
+		.input	= "\x69\xf4\xe3\xaf\x02\x80\xb2\xbc"
+			  "\x77\x0a\xda\x4c\x0c\xb2\xd8\xa9"
+			  "\x01\x9a\x7d\xd0\xb6\xd2\x9c\x7d"
+			  "\x95\x0c\xc5\xb9\x2c\x1d\x1d\xc0"
+			  "\xe4\xf5\x97\x8f\x95\x11\x13\x3c"
+			  "\x64\x86\x7b\xbd\xdb\xab\x15\xe4"
+			  "\x2f\xda\xad\x09\xad\x90\xa2\x62"
+			  "\xa5\x35\xc9\x97\x04\x6b\x20\xb9"
+			  "\x51\x31\x8f\xc2\xb5\x70\x10\x99"
+			  "\x13\x65\xa4\x96\x88\x43\x8c\x81"
+			  "\x31\x30\x4e\x4c\xf4\xe2\xc0\x47"
+			  "\x00\xc9\xb1\x31\xdc\xbb\x36\x0d"
+			  "\xa3\x58\x03\x0a\xbe\x40\x26\x83"
+			  "\x12\x4c\x2a\x31\xe7\x49\xc7\xfc"
+			  "\x1c\x3c\x41\x84\x7c\xc0\x42\x06"
+			  "\xac\xf2\x34\x7a\x6c\x54\x3a\x24"
+			  "\x9c\xc9\xcf\xb8\x7a\x80\x5e\xb0"
+			  "\xf6\x5a\xa2\xbd\x55\x9b\x51\x86",
+		.ilen	= 144,
+		.result	= "\x4f\x2c\x1f\xbd\x82\x1e\xc6\x55"
+			  "\x9e\x95\xc3\xa0\x6c\x69\xe7\x5b"
+			  "\x43\xc8\xd9\x78\x7f\x39\x26\xe3"
+			  "\x8f\xd4\x3b\x90\x65\x59\xcf\xaf"
+			  "\xe6\x2e\xf2\xd7\xec\xb9\x43\xe3"
+			  "\x8c\x47\x77\x50\x97\x9f\x23\x99"
+			  "\x35\x98\xd0\x74\xd0\x9e\xb5\xe9"
+			  "\x21\x24\x19\xac\xd1\xa4\x58\x5f"
+			  "\xd4\xaf\xf6\xba\x8e\x01\x85\x1d"
+			  "\x52\x8a\x3c\x86\x2b\xea\x49\x80"
+			  "\x4e\xef\x5c\xbc\xc0\x4b\x38\xed"
+			  "\xa6\x58\x42\x88\xe7\xec\x0b\xd0"
+			  "\xec\xfc\xc8\x56\x4a\x26\xcb\xcd"
+			  "\x9c\x54\xe8\xed\x6f\xd2\x9f\xe3"
+			  "\x88\x3d\x78\x4d\x9d\x38\x8f\x02"
+			  "\x3d\xe6\xf8\xff\x9a\x7d\xb5\x37"
+			  "\xaf\xae\x98\xb4\x12\xa4\x9c\x57"
+			  "\xc3\xed\x12\x04\x20\x32\xca\x31",
+		.rlen	= 144,
 	},
 };
 
@@ -3146,6 +3434,52 @@ static struct cipher_testvec aes_cbc_enc_tv_template[] = {
 			  "\xb2\xeb\x05\xe2\xc3\x9b\xe9\xfc"
 			  "\xda\x6c\x19\x07\x8c\x6a\x9d\x1b",
 		.rlen	= 64,
+	}, {
+		.key	= "\x85\xde\x12\x55\xe4\xc8\x31\xec"
+			  "\x9a\x5f\x16\x7a\xd0\xb1\x6e\xa0"
+			  "\x38\xeb\xc0\x5f\x72\x65\x25\x71"
+			  "\x1a\x0e\x86\xb6\x77\xa3\x9c\xbd",
+		.klen	= 32,
+		.iv	= "\xe1\x55\x9b\xe8\x88\xa1\xb4\xef"
+			  "\x78\x28\x1c\x4f\x77\xb6\xbc\xf4",
+		.input	= "\xd7\x39\x6b\xf2\x57\x80\x44\x20"
+			  "\xf9\x51\x8b\xab\x48\x80\xc4\x3f"
+			  "\xbc\xf9\xe3\x8c\x2f\x3f\xcc\x6e"
+			  "\x39\x5a\x25\xb6\x9b\x02\x0f\x0f"
+			  "\x9a\x8d\x80\x1e\x68\xf6\x5e\x4d"
+			  "\x68\x4a\x48\xcc\x87\xa1\x97\x6b"
+			  "\xa5\x27\xc8\x98\x35\x3b\x25\x99"
+			  "\x4c\xf7\xfa\x07\x10\xb5\x8e\xc9"
+			  "\x2d\x08\x68\x39\x0a\xd8\xe6\xd0"
+			  "\x3b\x3b\x29\xfd\xb6\x76\x02\x2d"
+			  "\xed\x89\xd9\x5f\xdd\x71\xd9\x66"
+			  "\x44\x73\x18\x3f\xd1\x4a\x6b\x7f"
+			  "\xfe\xad\x3e\xf6\x00\x34\xbb\x24"
+			  "\xcd\xa9\xd5\xc0\xa9\x7f\x1b\x14"
+			  "\xb6\xd9\xb4\x84\x34\xca\xf3\xd6"
+			  "\x94\x6a\x18\xb0\xb5\x9e\x79\xd0"
+			  "\xc6\xb2\xa6\xfc\x6d\xce\x81\x52"
+			  "\x71\x50\x30\xb1\x71\x5b\x46\x93",
+		.ilen	= 144,
+		.result	= "\x14\xaa\x8a\x75\xa7\x35\x16\x94"
+			  "\xa1\x46\xab\x9b\xeb\x2f\x6e\x15"
+			  "\xc0\x3e\x60\xcd\xe9\x5e\x35\x26"
+			  "\x76\x98\xed\xeb\x99\x56\x18\xe5"
+			  "\xa7\xaf\xa1\x18\x72\x12\x6f\x0a"
+			  "\xd1\x58\x6a\x11\x2b\xbe\xff\x66"
+			  "\x9d\xa4\xdd\xde\xbf\x5c\x32\xf7"
+			  "\x0d\xd1\xd1\x61\x3d\x5a\xb0\x74"
+			  "\x68\x8c\x61\x61\xf8\x98\xa2\x68"
+			  "\x89\x57\x76\x27\x0e\x68\xb6\x89"
+			  "\x19\xa5\x94\xf8\x8d\xff\xb9\xef"
+			  "\xf4\xcc\xb5\xfd\x3e\x4f\xe9\x11"
+			  "\xb1\x2a\x51\x5e\x4f\x62\x11\x3f"
+			  "\x16\x8c\xd9\x94\x94\x8d\x18\x50"
+			  "\x77\xdd\xd6\x54\xe3\xb2\x2e\x2a"
+			  "\xa9\x3e\xeb\x35\x18\x1d\xb3\x4a"
+			  "\x27\x77\x4b\x63\x1e\xb0\x3d\x99"
+			  "\xab\x9e\x77\x25\xd6\x31\xe0\x08",
+		.rlen	= 144,
 	},
 };
 
@@ -3228,6 +3562,52 @@ static struct cipher_testvec aes_cbc_dec_tv_template[] = {
 			  "\xf6\x9f\x24\x45\xdf\x4f\x9b\x17"
 			  "\xad\x2b\x41\x7b\xe6\x6c\x37\x10",
 		.rlen	= 64,
+	}, {
+		.key	= "\x85\xde\x12\x55\xe4\xc8\x31\xec"
+			  "\x9a\x5f\x16\x7a\xd0\xb1\x6e\xa0"
+			  "\x38\xeb\xc0\x5f\x72\x65\x25\x71"
+			  "\x1a\x0e\x86\xb6\x77\xa3\x9c\xbd",
+		.klen	= 32,
+		.iv	= "\xe1\x55\x9b\xe8\x88\xa1\xb4\xef"
+			  "\x78\x28\x1c\x4f\x77\xb6\xbc\xf4",
+		.input	= "\x14\xaa\x8a\x75\xa7\x35\x16\x94"
+			  "\xa1\x46\xab\x9b\xeb\x2f\x6e\x15"
+			  "\xc0\x3e\x60\xcd\xe9\x5e\x35\x26"
+			  "\x76\x98\xed\xeb\x99\x56\x18\xe5"
+			  "\xa7\xaf\xa1\x18\x72\x12\x6f\x0a"
+			  "\xd1\x58\x6a\x11\x2b\xbe\xff\x66"
+			  "\x9d\xa4\xdd\xde\xbf\x5c\x32\xf7"
+			  "\x0d\xd1\xd1\x61\x3d\x5a\xb0\x74"
+			  "\x68\x8c\x61\x61\xf8\x98\xa2\x68"
+			  "\x89\x57\x76\x27\x0e\x68\xb6\x89"
+			  "\x19\xa5\x94\xf8\x8d\xff\xb9\xef"
+			  "\xf4\xcc\xb5\xfd\x3e\x4f\xe9\x11"
+			  "\xb1\x2a\x51\x5e\x4f\x62\x11\x3f"
+			  "\x16\x8c\xd9\x94\x94\x8d\x18\x50"
+			  "\x77\xdd\xd6\x54\xe3\xb2\x2e\x2a"
+			  "\xa9\x3e\xeb\x35\x18\x1d\xb3\x4a"
+			  "\x27\x77\x4b\x63\x1e\xb0\x3d\x99"
+			  "\xab\x9e\x77\x25\xd6\x31\xe0\x08",
+		.ilen	= 144,
+		.result	= "\xd7\x39\x6b\xf2\x57\x80\x44\x20"
+			  "\xf9\x51\x8b\xab\x48\x80\xc4\x3f"
+			  "\xbc\xf9\xe3\x8c\x2f\x3f\xcc\x6e"
+			  "\x39\x5a\x25\xb6\x9b\x02\x0f\x0f"
+			  "\x9a\x8d\x80\x1e\x68\xf6\x5e\x4d"
+			  "\x68\x4a\x48\xcc\x87\xa1\x97\x6b"
+			  "\xa5\x27\xc8\x98\x35\x3b\x25\x99"
+			  "\x4c\xf7\xfa\x07\x10\xb5\x8e\xc9"
+			  "\x2d\x08\x68\x39\x0a\xd8\xe6\xd0"
+			  "\x3b\x3b\x29\xfd\xb6\x76\x02\x2d"
+			  "\xed\x89\xd9\x5f\xdd\x71\xd9\x66"
+			  "\x44\x73\x18\x3f\xd1\x4a\x6b\x7f"
+			  "\xfe\xad\x3e\xf6\x00\x34\xbb\x24"
+			  "\xcd\xa9\xd5\xc0\xa9\x7f\x1b\x14"
+			  "\xb6\xd9\xb4\x84\x34\xca\xf3\xd6"
+			  "\x94\x6a\x18\xb0\xb5\x9e\x79\xd0"
+			  "\xc6\xb2\xa6\xfc\x6d\xce\x81\x52"
+			  "\x71\x50\x30\xb1\x71\x5b\x46\x93",
+		.rlen	= 144,
 	},
 };
 
@@ -4203,6 +4583,55 @@ static struct cipher_testvec aes_ctr_enc_tv_template[] = {
 			  "\xdf\xc9\xc5\x8d\xb6\x7a\xad\xa6"
 			  "\x13\xc2\xdd\x08\x45\x79\x41\xa6",
 		.rlen	= 64,
+	}, {
+		.key	= "\x59\x4b\xc4\x0b\xea\xfa\x8d\xaa"
+			  "\xab\xbb\x95\x94\xcf\x5c\x34\x71"
+			  "\xf1\xe5\xc7\x88\xc7\x87\xb9\x50",
+		.klen	= 24,
+		.iv	= "\x29\x5d\x0f\x47\x00\xdc\x76\xff"
+			  "\x7f\x1d\x97\xa9\xff\xff\xff\xfc",
+		.input	= "\x26\x75\x85\x01\x74\xb7\xda\xd9"
+			  "\xd9\x9f\xab\xfd\x27\xca\xb3\xa2"
+			  "\x62\x5b\x3d\xfe\xad\x24\x1a\x98"
+			  "\xf4\x9e\xed\xa2\x88\xc8\x5b\xd2"
+			  "\x22\xa9\xe6\x52\xe7\x1b\xb7\x66"
+			  "\x89\x5f\xde\x42\x05\xf1\x1c\xfd"
+			  "\xdb\x07\xde\xaf\x8d\x02\x0e\xa9"
+			  "\xb8\x26\x4b\xde\x77\x6f\xc4\x03"
+			  "\x57\x61\xdb\xcd\x9c\x93\xfe\xc9"
+			  "\x20\x9f\xe3\x5d\xa5\xd9\xbe\x37"
+			  "\x51\x46\x1f\x40\x10\x0d\x4b\xa4"
+			  "\xb9\x55\xa2\xa4\x59\xf8\x71\x75"
+			  "\x91\xd0\xc8\x09\xf9\x61\x4d\x81"
+			  "\x77\xca\x20\x60\xe7\x4a\x08\xfc"
+			  "\x71\xa3\x34\x5a\x9c\x25\xb8\xd1"
+			  "\xd6\xfe\x68\xd9\x34\x6f\x87\xc9"
+			  "\x7a\x11\x30\x72\xbb\x03\xcf\xb6"
+			  "\x35\x26\x42\xe7\x2f\x55\x64\x05"
+			  "\x87\x95\xf4\xa4\x4f\x2a\xc8\x27"
+			  "\xea\xa7\xad",
+		.ilen	= 155,
+		.result	= "\xa2\x55\xb8\xf2\x48\x78\x6d\x84"
+			  "\x2a\xe6\xe5\xd8\x91\x90\x17\x63"
+			  "\xab\x68\xd7\xa0\x8f\x03\xfd\x74"
+			  "\x12\xb2\x35\x82\x8b\x74\xa4\x0b"
+			  "\x51\x4e\x81\x11\x27\x2d\x28\x07"
+			  "\x76\xac\x84\x23\x7a\x3a\x7c\x75"
+			  "\xa2\xe7\x85\x4c\x07\xc3\x25\x2a"
+			  "\x08\xec\x17\x43\xa3\x3d\x89\x50"
+			  "\x78\x6a\x44\x81\x8d\x41\xcf\x15"
+			  "\xc6\xd3\x54\x26\x0b\x98\xae\x81"
+			  "\xb9\x9a\xd6\x27\xc3\x04\x15\xd8"
+			  "\xd8\x08\x6e\x9f\xee\xd1\xf5\x5e"
+			  "\xa4\xe7\x1a\x9b\x9b\xfa\xa5\x10"
+			  "\x83\xb6\xcb\xbb\xb0\xd8\xc2\xda"
+			  "\xa6\xd7\x75\x0e\xf8\xc6\xae\x45"
+			  "\x65\xdb\x8b\x08\x77\x89\xe1\x55"
+			  "\x7d\xb3\x5d\x19\x46\x3f\x01\x51"
+			  "\x6f\x0d\x0d\x00\x3e\x8f\x21\x48"
+			  "\xa8\x2c\x67\xaa\x64\xfc\xe3\x2e"
+			  "\x1d\x96\x54",
+		.rlen	= 155,
 	}
 };
 
@@ -4282,6 +4711,55 @@ static struct cipher_testvec aes_ctr_dec_tv_template[] = {
 			  "\xf6\x9f\x24\x45\xdf\x4f\x9b\x17"
 			  "\xad\x2b\x41\x7b\xe6\x6c\x37\x10",
 		.rlen	= 64,
+	}, {
+		.key	= "\x59\x4b\xc4\x0b\xea\xfa\x8d\xaa"
+			  "\xab\xbb\x95\x94\xcf\x5c\x34\x71"
+			  "\xf1\xe5\xc7\x88\xc7\x87\xb9\x50",
+		.klen	= 24,
+		.iv	= "\x29\x5d\x0f\x47\x00\xdc\x76\xff"
+			  "\x7f\x1d\x97\xa9\xff\xff\xff\xfc",
+		.input	= "\xa2\x55\xb8\xf2\x48\x78\x6d\x84"
+			  "\x2a\xe6\xe5\xd8\x91\x90\x17\x63"
+			  "\xab\x68\xd7\xa0\x8f\x03\xfd\x74"
+			  "\x12\xb2\x35\x82\x8b\x74\xa4\x0b"
+			  "\x51\x4e\x81\x11\x27\x2d\x28\x07"
+			  "\x76\xac\x84\x23\x7a\x3a\x7c\x75"
+			  "\xa2\xe7\x85\x4c\x07\xc3\x25\x2a"
+			  "\x08\xec\x17\x43\xa3\x3d\x89\x50"
+			  "\x78\x6a\x44\x81\x8d\x41\xcf\x15"
+			  "\xc6\xd3\x54\x26\x0b\x98\xae\x81"
+			  "\xb9\x9a\xd6\x27\xc3\x04\x15\xd8"
+			  "\xd8\x08\x6e\x9f\xee\xd1\xf5\x5e"
+			  "\xa4\xe7\x1a\x9b\x9b\xfa\xa5\x10"
+			  "\x83\xb6\xcb\xbb\xb0\xd8\xc2\xda"
+			  "\xa6\xd7\x75\x0e\xf8\xc6\xae\x45"
+			  "\x65\xdb\x8b\x08\x77\x89\xe1\x55"
+			  "\x7d\xb3\x5d\x19\x46\x3f\x01\x51"
+			  "\x6f\x0d\x0d\x00\x3e\x8f\x21\x48"
+			  "\xa8\x2c\x67\xaa\x64\xfc\xe3\x2e"
+			  "\x1d\x96\x54",
+		.ilen	= 155,
+		.result	= "\x26\x75\x85\x01\x74\xb7\xda\xd9"
+			  "\xd9\x9f\xab\xfd\x27\xca\xb3\xa2"
+			  "\x62\x5b\x3d\xfe\xad\x24\x1a\x98"
+			  "\xf4\x9e\xed\xa2\x88\xc8\x5b\xd2"
+			  "\x22\xa9\xe6\x52\xe7\x1b\xb7\x66"
+			  "\x89\x5f\xde\x42\x05\xf1\x1c\xfd"
+			  "\xdb\x07\xde\xaf\x8d\x02\x0e\xa9"
+			  "\xb8\x26\x4b\xde\x77\x6f\xc4\x03"
+			  "\x57\x61\xdb\xcd\x9c\x93\xfe\xc9"
+			  "\x20\x9f\xe3\x5d\xa5\xd9\xbe\x37"
+			  "\x51\x46\x1f\x40\x10\x0d\x4b\xa4"
+			  "\xb9\x55\xa2\xa4\x59\xf8\x71\x75"
+			  "\x91\xd0\xc8\x09\xf9\x61\x4d\x81"
+			  "\x77\xca\x20\x60\xe7\x4a\x08\xfc"
+			  "\x71\xa3\x34\x5a\x9c\x25\xb8\xd1"
+			  "\xd6\xfe\x68\xd9\x34\x6f\x87\xc9"
+			  "\x7a\x11\x30\x72\xbb\x03\xcf\xb6"
+			  "\x35\x26\x42\xe7\x2f\x55\x64\x05"
+			  "\x87\x95\xf4\xa4\x4f\x2a\xc8\x27"
+			  "\xea\xa7\xad",
+		.rlen	= 155,
 	}
 };
 
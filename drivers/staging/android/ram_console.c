@@ -26,6 +26,14 @@
 #ifdef CONFIG_ANDROID_RAM_CONSOLE_ERROR_CORRECTION
 #include <linux/rslib.h>
 #endif
+#ifdef CONFIG_ANDROID_RAM_CONSOLE_DEFERRED_ECC
+#include <linux/irq_work.h>
+#include <linux/notifier.h>
+#include <linux/reboot.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/workqueue.h>
+#endif
 
 struct ram_console_buffer {
 	uint32_t    sig;
@@ -56,6 +64,24 @@ static int ram_console_bad_blocks;
 #define ECC_POLY CONFIG_ANDROID_RAM_CONSOLE_ERROR_CORRECTION_POLYNOMIAL
 #endif
 
+#ifdef CONFIG_ANDROID_RAM_CONSOLE_DEFERRED_ECC
+/*
+ * Encoding the parity of every block a console write touches is by far
+ * the most expensive part of a write, and it used to be done for each
+ * write, from whatever context was calling printk. Instead, a write
+ * copies its text to the persistent buffer at once and only marks the
+ * blocks it touched, and a work item encodes each marked block once per
+ * batch. The header is small and still encoded on every write.
+ *
+ * The text itself is never held back, so the last messages before a
+ * hang and a watchdog reset are kept. Oopses and panics are encoded
+ * synchronously.
+ */
+static DEFINE_SPINLOCK(ram_console_flush_lock);
+static unsigned long *ram_console_dirty;	/* blocks with stale parity */
+static int ram_console_sync;		/* encode at once, after a panic */
+#endif
+
 #ifdef CONFIG_ANDROID_RAM_CONSOLE_ERROR_CORRECTION
 static void ram_console_encode_rs8(uint8_t *data, size_t len, uint8_t *ecc)
 {
@@ -79,27 +105,48 @@ static int ram_console_decode_rs8(void *data, size_t len, uint8_t *ecc)
 }
 #endif
 
-static void ram_console_update(const char *s, unsigned int count)
+#ifdef CONFIG_ANDROID_RAM_CONSOLE_ERROR_CORRECTION
+static void ram_console_encode_block(unsigned int index)
 {
 	struct ram_console_buffer *buffer = ram_console_buffer;
-#ifdef CONFIG_ANDROID_RAM_CONSOLE_ERROR_CORRECTION
 	uint8_t *buffer_end = buffer->data + ram_console_buffer_size;
-	uint8_t *block;
-	uint8_t *par;
+	uint8_t *block = buffer->data + index * ECC_BLOCK_SIZE;
+	uint8_t *par = ram_console_par_buffer + index * ECC_SIZE;
 	int size = ECC_BLOCK_SIZE;
+
+	if (block + ECC_BLOCK_SIZE > buffer_end)
+		size = buffer_end - block;
+	ram_console_encode_rs8(block, size, par);
+}
+#endif
+
+static void ram_console_update(const char *s, unsigned int count)
+{
+	struct ram_console_buffer *buffer = ram_console_buffer;
+#ifdef CONFIG_ANDROID_RAM_CONSOLE_ERROR_CORRECTION
+	unsigned int block, end;
 #endif
 	memcpy(buffer->data + buffer->start, s, count);
 #ifdef CONFIG_ANDROID_RAM_CONSOLE_ERROR_CORRECTION
-	block = buffer->data + (buffer->start & ~(ECC_BLOCK_SIZE - 1));
-	par = ram_console_par_buffer +
-	      (buffer->start / ECC_BLOCK_SIZE) * ECC_SIZE;
-	do {
-		if (block + ECC_BLOCK_SIZE > buffer_end)
-			size = buffer_end - block;
-		ram_console_encode_rs8(block, size, par);
-		block += ECC_BLOCK_SIZE;
-		par += ECC_SIZE;
-	} while (block < buffer->data + buffer->start + count);
+	block = buffer->start / ECC_BLOCK_SIZE;
+	end = DIV_ROUND_UP(buffer->start + count, ECC_BLOCK_SIZE);
+	for (; block < end; block++) {
+#ifdef CONFIG_ANDROID_RAM_CONSOLE_DEFERRED_ECC
+		/*
+		 * Clear the parity of a block when it goes stale: after a
+		 * reset before the flush, the block then fails to decode
+		 * and is kept as written, rather than "corrected" back to
+		 * its old text.
+		 */
+		if (ram_console_dirty) {
+			if (!__test_and_set_bit(block, ram_console_dirty))
+				memset(ram_console_par_buffer +
+				       block * ECC_SIZE, 0, ECC_SIZE);
+			continue;
+		}
+#endif
+		ram_console_encode_block(block);
+	}
 #endif
 }
 
@@ -114,8 +161,8 @@ static void ram_console_update_header(void)
 #endif
 }
 
-static void
-ram_console_write(struct console *console, const char *s, unsigned int count)
+/* Append to the persistent buffer; the header is left to the caller */
+static void ram_console_write_buffer(const char *s, unsigned int count)
 {
 	int rem;
 	struct ram_console_buffer *buffer = ram_console_buffer;
@@ -137,6 +184,133 @@ ram_console_write(struct console *console, const char *s, unsigned int count)
 	buffer->start += count;
 	if (buffer->size < ram_console_buffer_size)
 		buffer->size += count;
+}
+
+#ifdef CONFIG_ANDROID_RAM_CONSOLE_DEFERRED_ECC
+/* Called with ram_console_flush_lock held and interrupts disabled */
+static void ram_console_flush(void)
+{
+	unsigned int nblocks = DIV_ROUND_UP(ram_console_buffer_size,
+					    ECC_BLOCK_SIZE);
+	unsigned int block;
+
+	for_each_set_bit(block, ram_console_dirty, nblocks) {
+		__clear_bit(block, ram_console_dirty);
+		ram_console_encode_block(block);
+	}
+}
+
+/*
+ * Take the flush lock with interrupts disabled. During an oops its owner
+ * may be the very code that oopsed, and after a panic it may have been
+ * stopped with the lock held: go on without it rather than deadlock.
+ */
+static bool ram_console_lock(void)
+{
+	if (spin_trylock(&ram_console_flush_lock))
+		return true;
+	if (oops_in_progress || ram_console_sync)
+		return false;
+	spin_lock(&ram_console_flush_lock);
+	return true;
+}
+
+static void ram_console_flush_work_fn(struct work_struct *work)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&ram_console_flush_lock, flags);
+	ram_console_flush();
+	spin_unlock_irqrestore(&ram_console_flush_lock, flags);
+}
+
+static DECLARE_WORK(ram_console_flush_work, ram_console_flush_work_fn);
+
+/*
+ * The write path may run with scheduler locks held, so it only raises an
+ * irq_work, which kicks the flusher from a safe context.
+ */
+static void ram_console_irq_work_fn(struct irq_work *work)
+{
+	schedule_work(&ram_console_flush_work);
+}
+
+static struct irq_work ram_console_irq_work;
+
+static int ram_console_panic(struct notifier_block *nb,
+			     unsigned long event, void *unused)
+{
+	unsigned long flags;
+	bool locked;
+
+	ram_console_sync = 1;
+	local_irq_save(flags);
+	locked = ram_console_lock();
+	ram_console_flush();
+	if (locked)
+		spin_unlock(&ram_console_flush_lock);
+	local_irq_restore(flags);
+	return NOTIFY_DONE;
+}
+
+static struct notifier_block ram_console_panic_nb = {
+	.notifier_call	= ram_console_panic,
+};
+
+static int ram_console_reboot(struct notifier_block *nb,
+			      unsigned long event, void *unused)
+{
+	ram_console_flush_work_fn(NULL);
+	return NOTIFY_DONE;
+}
+
+static struct notifier_block ram_console_reboot_nb = {
+	.notifier_call	= ram_console_reboot,
+};
+
+static void ram_console_deferred_init(void)
+{
+	unsigned int nblocks = DIV_ROUND_UP(ram_console_buffer_size,
+					    ECC_BLOCK_SIZE);
+
+	ram_console_dirty = kzalloc(BITS_TO_LONGS(nblocks) * sizeof(long),
+				    GFP_KERNEL);
+	if (ram_console_dirty == NULL) {
+		printk(KERN_INFO "ram_console: no memory for the dirty map, "
+		       "encoding synchronously\n");
+		return;
+	}
+
+	init_irq_work(&ram_console_irq_work, ram_console_irq_work_fn);
+	atomic_notifier_chain_register(&panic_notifier_list,
+				       &ram_console_panic_nb);
+	register_reboot_notifier(&ram_console_reboot_nb);
+}
+#endif
+
+static void
+ram_console_write(struct console *console, const char *s, unsigned int count)
+{
+#ifdef CONFIG_ANDROID_RAM_CONSOLE_DEFERRED_ECC
+	unsigned long flags;
+	bool locked;
+
+	if (ram_console_dirty) {
+		local_irq_save(flags);
+		locked = ram_console_lock();
+		ram_console_write_buffer(s, count);
+		ram_console_update_header();
+		if (unlikely(oops_in_progress || ram_console_sync))
+			ram_console_flush();
+		else
+			irq_work_queue(&ram_console_irq_work);
+		if (locked)
+			spin_unlock(&ram_console_flush_lock);
+		local_irq_restore(flags);
+		return;
+	}
+#endif
+	ram_console_write_buffer(s, count);
 	ram_console_update_header();
 }
 
@@ -319,6 +493,9 @@ static int __init ram_console_init(struct ram_console_buffer *buffer,
 	buffer->start = 0;
 	buffer->size = 0;
 
+#ifdef CONFIG_ANDROID_RAM_CONSOLE_DEFERRED_ECC
+	ram_console_deferred_init();
+#endif
 	register_console(&ram_console);
 #ifdef CONFIG_ANDROID_RAM_CONSOLE_ENABLE_VERBOSE
 	console_verbose();
@@ -16,6 +16,7 @@
 #include <linux/f2fs_fs.h>
 #include <linux/pagevec.h>
 #include <linux/swap.h>
+#include <linux/kthread.h>
 
 #include "f2fs.h"
 #include "node.h"
@@ -1092,6 +1093,149 @@ out:
 	trace_f2fs_write_checkpoint(sbi->sb, cpc->reason, "finish checkpoint");
 }
 
+static void __checkpoint_and_complete_reqs(struct f2fs_sb_info *sbi)
+{
+	struct ckpt_req_control *cprc = sbi->cprc_info;
+	struct ckpt_req *req, *next;
+	struct cp_control cpc;
+
+	cpc.reason = __get_cp_reason(sbi);
+
+	mutex_lock(&sbi->gc_mutex);
+	write_checkpoint(sbi, &cpc);
+	mutex_unlock(&sbi->gc_mutex);
+
+	cprc->issued_ckpt++;
+
+	for (req = cprc->dispatch_list; req; req = next) {
+		unsigned int elapsed = jiffies_to_msecs(jiffies -
+							req->queue_time);
+
+		cprc->total_req++;
+		cprc->total_time += elapsed;
+		if (elapsed > cprc->peak_time)
+			cprc->peak_time = elapsed;
+
+		next = req->next;
+		complete(&req->wait);
+	}
+	cprc->dispatch_list = NULL;
+}
+
+/*
+ * Requests queued while a checkpoint is running are served together by the
+ * next one, since their data was not covered by the running checkpoint.
+ */
+static int issue_checkpoint_thread(void *data)
+{
+	struct f2fs_sb_info *sbi = data;
+	struct ckpt_req_control *cprc = sbi->cprc_info;
+	wait_queue_head_t *q = &cprc->ckpt_wait_queue;
+repeat:
+	if (kthread_should_stop())
+		return 0;
+
+	spin_lock(&cprc->issue_lock);
+	if (cprc->issue_list) {
+		cprc->dispatch_list = cprc->issue_list;
+		cprc->issue_list = cprc->issue_tail = NULL;
+	}
+	spin_unlock(&cprc->issue_lock);
+
+	if (cprc->dispatch_list)
+		__checkpoint_and_complete_reqs(sbi);
+
+	wait_event_interruptible(*q,
+			kthread_should_stop() || cprc->issue_list);
+	goto repeat;
+}
+
+/*
+ * cprc_rwsem is held across the wait, so that remount cannot free cprc_info
+ * until every queued request has been served.
+ */
+void f2fs_issue_checkpoint(struct f2fs_sb_info *sbi)
+{
+	struct ckpt_req_control *cprc;
+	struct ckpt_req req;
+
+	down_read(&sbi->cprc_rwsem);
+	cprc = sbi->cprc_info;
+	if (!test_opt(sbi, CP_MERGE) || !cprc) {
+		struct cp_control cpc;
+
+		up_read(&sbi->cprc_rwsem);
+
+		cpc.reason = __get_cp_reason(sbi);
+
+		mutex_lock(&sbi->gc_mutex);
+		write_checkpoint(sbi, &cpc);
+		mutex_unlock(&sbi->gc_mutex);
+		return;
+	}
+
+	init_completion(&req.wait);
+	req.next = NULL;
+	req.queue_time = jiffies;
+
+	spin_lock(&cprc->issue_lock);
+	if (cprc->issue_list)
+		cprc->issue_tail->next = &req;
+	else
+		cprc->issue_list = &req;
+	cprc->issue_tail = &req;
+	spin_unlock(&cprc->issue_lock);
+
+	if (!cprc->dispatch_list)
+		wake_up(&cprc->ckpt_wait_queue);
+
+	wait_for_completion(&req.wait);
+	up_read(&sbi->cprc_rwsem);
+}
+
+int create_ckpt_req_control(struct f2fs_sb_info *sbi)
+{
+	dev_t dev = sbi->sb->s_bdev->bd_dev;
+	struct ckpt_req_control *cprc;
+	int err = 0;
+
+	cprc = kzalloc(sizeof(struct ckpt_req_control), GFP_KERNEL);
+	if (!cprc)
+		return -ENOMEM;
+	spin_lock_init(&cprc->issue_lock);
+	init_waitqueue_head(&cprc->ckpt_wait_queue);
+
+	down_write(&sbi->cprc_rwsem);
+	sbi->cprc_info = cprc;
+	cprc->f2fs_issue_ckpt = kthread_run(issue_checkpoint_thread, sbi,
+				"f2fs_ckpt-%u:%u", MAJOR(dev), MINOR(dev));
+	if (IS_ERR(cprc->f2fs_issue_ckpt)) {
+		err = PTR_ERR(cprc->f2fs_issue_ckpt);
+		kfree(cprc);
+		sbi->cprc_info = NULL;
+	}
+	up_write(&sbi->cprc_rwsem);
+
+	return err;
+}
+
+void destroy_ckpt_req_control(struct f2fs_sb_info *sbi)
+{
+	struct ckpt_req_control *cprc;
+
+	/* waits for the issuers, so no request is left on the lists */
+	down_write(&sbi->cprc_rwsem);
+	cprc = sbi->cprc_info;
+	sbi->cprc_info = NULL;
+	up_write(&sbi->cprc_rwsem);
+
+	if (!cprc)
+		return;
+
+	kthread_stop(cprc->f2fs_issue_ckpt);
+	kfree(cprc);
+}
+
 void init_ino_entry_info(struct f2fs_sb_info *sbi)
 {
 	int i;
@@ -82,6 +82,7 @@ static void f2fs_write_end_io(struct bio *bio, int err)
 			!list_empty(&sbi->cp_wait.task_list))
 		wake_up(&sbi->cp_wait);
 
+	end_ipu_latency_sample(sbi, bio);
 	bio_put(bio);
 }
 
@@ -116,6 +117,9 @@ static void __submit_merged_bio(struct f2fs_bio_info *io)
 	else
 		trace_f2fs_submit_write_bio(io->sbi->sb, fio, io->bio);
 
+	if (fio->type == DATA && !is_read_io(fio->rw))
+		start_ipu_latency_sample(io->sbi, io->bio, fio->is_ipu);
+
 	submit_bio(fio->rw, io->bio);
 	io->bio = NULL;
 }
@@ -1649,6 +1653,10 @@ int do_write_data_page(struct f2fs_io_info *fio)
 
 	set_page_writeback(page);
 
+	/* cleaning moves should not warm up the file */
+	if (!is_cold_data(page))
+		update_data_temperature(inode, fio->blk_addr);
+
 	/*
 	 * If current allocation needs SSR,
 	 * it had better in-place writes for updated data.
@@ -1656,6 +1664,7 @@ int do_write_data_page(struct f2fs_io_info *fio)
 	if (unlikely(fio->blk_addr != NEW_ADDR &&
 			!is_cold_data(page) &&
 			need_inplace_update(inode))) {
+		fio->is_ipu = true;
 		rewrite_data_page(fio);
 		set_inode_flag(F2FS_I(inode), FI_UPDATE_WRITE);
 		trace_f2fs_do_write_data_page(page, IPU);
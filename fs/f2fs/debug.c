@@ -86,6 +86,33 @@ static void update_general_status(struct f2fs_sb_info *sbi)
 	}
 
 	si->inplace_count = atomic_read(&sbi->inplace_count);
+
+	if (SM_I(sbi)->ipu_info) {
+		struct ipu_adaptive_info *ai = SM_I(sbi)->ipu_info;
+
+		si->ipu_lat = ai->ipu_lat;
+		si->opu_lat = ai->opu_lat;
+		si->ipu_samples = ai->ipu_samples;
+		si->opu_samples = ai->opu_samples;
+		si->free_secs_trend = ai->free_secs_trend;
+		for (i = 0; i < NR_IPU_CLASS; i++) {
+			si->ipu_class_on[i] = ai->use_ipu[i];
+			si->ipu_class_ipu[i] = ai->nr_ipu[i];
+			si->ipu_class_opu[i] = ai->nr_opu[i];
+		}
+	}
+
+	down_read(&sbi->cprc_rwsem);
+	if (sbi->cprc_info) {
+		struct ckpt_req_control *cprc = sbi->cprc_info;
+
+		si->cp_merge_issued = cprc->issued_ckpt;
+		si->cp_merge_reqs = cprc->total_req;
+		si->cp_merge_peak = cprc->peak_time;
+		si->cp_merge_avg = cprc->total_req ?
+			div_u64(cprc->total_time, cprc->total_req) : 0;
+	}
+	up_read(&sbi->cprc_rwsem);
 }
 
 /*
@@ -139,6 +166,7 @@ static void update_mem_info(struct f2fs_sb_info *sbi)
 
 	/* build sm */
 	si->base_mem += sizeof(struct f2fs_sm_info);
+	si->base_mem += sizeof(struct ipu_adaptive_info);
 
 	/* build sit */
 	si->base_mem += sizeof(struct sit_info);
@@ -163,6 +191,7 @@ static void update_mem_info(struct f2fs_sb_info *sbi)
 	si->base_mem += sizeof(struct dirty_seglist_info);
 	si->base_mem += NR_DIRTY_TYPE * f2fs_bitmap_size(MAIN_SEGS(sbi));
 	si->base_mem += f2fs_bitmap_size(MAIN_SECS(sbi));
+	si->base_mem += MAIN_SECS(sbi) * sizeof(struct victim_entry);
 
 	/* build nm */
 	si->base_mem += sizeof(struct f2fs_nm_info);
@@ -179,6 +208,10 @@ get_cache:
 	if (SM_I(sbi)->cmd_control_info)
 		si->cache_mem += sizeof(struct flush_cmd_control);
 
+	/* build checkpoint merge thread */
+	if (sbi->cprc_info)
+		si->cache_mem += sizeof(struct ckpt_req_control);
+
 	/* free nids */
 	si->cache_mem += NM_I(sbi)->fcnt * sizeof(struct free_nid);
 	si->cache_mem += NM_I(sbi)->nat_cnt * sizeof(struct nat_entry);
@@ -264,6 +297,10 @@ static int stat_show(struct seq_file *s, void *v)
 		seq_printf(s, "  - Prefree: %d\n  - Free: %d (%d)\n\n",
 			   si->prefree_count, si->free_segs, si->free_secs);
 		seq_printf(s, "CP calls: %d\n", si->cp_count);
+		seq_printf(s, "  - merged: %u requests in %u CPs\n",
+			   si->cp_merge_reqs, si->cp_merge_issued);
+		seq_printf(s, "  - latency: avg %u ms, peak %u ms\n",
+			   si->cp_merge_avg, si->cp_merge_peak);
 		seq_printf(s, "GC calls: %d (BG: %d)\n",
 			   si->call_count, si->bg_gc);
 		seq_printf(s, "  - data segments : %d (%d)\n",
@@ -309,6 +346,23 @@ static int stat_show(struct seq_file *s, void *v)
 			seq_putc(s, '-');
 		seq_puts(s, "]\n\n");
 		seq_printf(s, "IPU: %u blocks\n", si->inplace_count);
+		if (SM_I(si->sbi)->ipu_policy & (0x1 << F2FS_IPU_ADAPTIVE)) {
+			static const char *class_name[NR_IPU_CLASS] = {
+				"hot", "warm", "cold"
+			};
+
+			seq_printf(s, "  - latency: IPU %u us (%u), OPU %u us (%u)\n",
+				   si->ipu_lat, si->ipu_samples,
+				   si->opu_lat, si->opu_samples);
+			seq_printf(s, "  - free section trend: %d\n",
+				   si->free_secs_trend);
+			for (j = 0; j < NR_IPU_CLASS; j++)
+				seq_printf(s, "  - %-4s: %s, IPU %u, OPU %u\n",
+					   class_name[j],
+					   si->ipu_class_on[j] ? "IPU" : "OPU",
+					   si->ipu_class_ipu[j],
+					   si->ipu_class_opu[j]);
+		}
 		seq_printf(s, "SSR: %u blocks in %u segments\n",
 			   si->block_count[SSR], si->segment_count[SSR]);
 		seq_printf(s, "LFS: %u blocks in %u segments\n",
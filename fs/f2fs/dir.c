@@ -778,6 +778,67 @@ bool f2fs_empty_dir(struct inode *dir)
 	return true;
 }
 
+/*
+ * Readahead the inode pages of the entries in a dentry block starting from
+ * bit_pos, so that the lookups and stats following a directory scan find
+ * them in the node cache.
+ */
+static void ra_dentry_inodes(struct inode *dir, struct f2fs_dentry_ptr *d,
+						unsigned int bit_pos)
+{
+	nid_t nids[MAX_RA_DENTRY_NODE];
+	int count = 0;
+
+	while (bit_pos < d->max) {
+		struct f2fs_dir_entry *de;
+
+		bit_pos = find_next_bit_le(d->bitmap, d->max, bit_pos);
+		if (bit_pos >= d->max)
+			break;
+
+		de = &d->dentry[bit_pos];
+		nids[count++] = le32_to_cpu(de->ino);
+		if (count == MAX_RA_DENTRY_NODE) {
+			ra_node_pages(F2FS_I_SB(dir), nids, count);
+			count = 0;
+		}
+
+		bit_pos += GET_DENTRY_SLOTS(le16_to_cpu(de->name_len));
+	}
+
+	if (count)
+		ra_node_pages(F2FS_I_SB(dir), nids, count);
+}
+
+/*
+ * Called by lookup with the dentry page holding the found entry. If the
+ * inode page of that entry is not cached, its siblings are likely not
+ * either, so read them all at once rather than one per lookup.
+ */
+void f2fs_ra_dentry_page_inodes(struct inode *dir, struct page *dentry_page,
+								nid_t ino)
+{
+	struct f2fs_sb_info *sbi = F2FS_I_SB(dir);
+	struct f2fs_dentry_block *dentry_blk;
+	struct f2fs_dentry_ptr d;
+	struct page *page;
+	bool cached;
+
+	if (f2fs_has_inline_dentry(dir))
+		return;
+
+	page = find_get_page(NODE_MAPPING(sbi), ino);
+	cached = page && PageUptodate(page);
+	f2fs_put_page(page, 0);
+	if (cached)
+		return;
+
+	dentry_blk = kmap(dentry_page);
+	make_dentry_ptr(dir, &d, (void *)dentry_blk, 1);
+	ra_dentry_inodes(dir, &d, 0);
+	kunmap(dentry_page);
+}
+
 bool f2fs_fill_dentries(struct file *file, void *dirent, filldir_t filldir,
 		struct f2fs_dentry_ptr *d, unsigned int n, unsigned int bit_pos,
 		struct f2fs_str *fstr)
@@ -876,6 +937,9 @@ static int f2fs_readdir(struct file *file, void *dirent, filldir_t filldir)
 
 		make_dentry_ptr(inode, &d, (void *)dentry_blk, 1);
 
+		if (F2FS_I_SB(inode)->readdir_ra)
+			ra_dentry_inodes(inode, &d, bit_pos);
+
 		if (f2fs_fill_dentries(file, dirent, filldir, &d, n, bit_pos, &fstr))
 			goto stop;
 
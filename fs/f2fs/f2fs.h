@@ -52,6 +52,7 @@
 #define F2FS_MOUNT_NOBARRIER		0x00000800
 #define F2FS_MOUNT_FASTBOOT		0x00001000
 #define F2FS_MOUNT_EXTENT_CACHE		0x00002000
+#define F2FS_MOUNT_CP_MERGE		0x00004000
 
 #define clear_opt(sbi, option)	(sbi->mount_opt.opt &= ~F2FS_MOUNT_##option)
 #define set_opt(sbi, option)	(sbi->mount_opt.opt |= F2FS_MOUNT_##option)
@@ -380,6 +381,7 @@ struct f2fs_map_blocks {
 #define FADVISE_LOST_PINO_BIT	0x02
 #define FADVISE_ENCRYPT_BIT	0x04
 #define FADVISE_ENC_NAME_BIT	0x08
+#define FADVISE_HOT_BIT		0x20
 
 #define file_is_cold(inode)	is_file(inode, FADVISE_COLD_BIT)
 #define file_wrong_pino(inode)	is_file(inode, FADVISE_LOST_PINO_BIT)
@@ -392,6 +394,18 @@ struct f2fs_map_blocks {
 #define file_clear_encrypt(inode) clear_file(inode, FADVISE_ENCRYPT_BIT)
 #define file_enc_name(inode)	is_file(inode, FADVISE_ENC_NAME_BIT)
 #define file_set_enc_name(inode) set_file(inode, FADVISE_ENC_NAME_BIT)
+#define file_is_hot(inode)	is_file(inode, FADVISE_HOT_BIT)
+#define file_set_hot(inode)	set_file(inode, FADVISE_HOT_BIT)
+#define file_clear_hot(inode)	clear_file(inode, FADVISE_HOT_BIT)
+
+/*
+ * Regular files learn their data temperature from rewrites. A rewrite of a
+ * block younger than hot_data_age seconds raises i_hot_score, and an older
+ * one lowers it. Files reaching HOT_DATA_SCORE_SET go to the hot data log
+ * until their score drops back to zero.
+ */
+#define HOT_DATA_SCORE_SET	8
+#define HOT_DATA_SCORE_MAX	16
 
 /* Encryption algorithms */
 #define F2FS_ENCRYPTION_MODE_INVALID		0
@@ -409,6 +423,7 @@ struct f2fs_inode_info {
 	unsigned long i_flags;		/* keep an inode flags for ioctl */
 	unsigned char i_advise;		/* use to give file attribute hints */
 	unsigned char i_dir_level;	/* use for dentry level for large dir */
+	unsigned char i_hot_score;	/* recent rewrite frequency of data */
 	unsigned int i_current_depth;	/* use only in directory structure */
 	unsigned int i_pino;		/* parent inode number */
 	umode_t i_acl_mode;		/* keep file acl mode temporarily */
@@ -580,6 +595,35 @@ struct flush_cmd_control {
 	struct flush_cmd *issue_tail;		/* list tail of issue list */
 };
 
+struct ckpt_req {
+	struct ckpt_req *next;
+	struct completion wait;
+	unsigned long queue_time;		/* jiffies when queued */
+};
+
+struct ckpt_req_control {
+	struct task_struct *f2fs_issue_ckpt;	/* checkpoint thread */
+	wait_queue_head_t ckpt_wait_queue;	/* waiting queue for wake-up */
+	struct ckpt_req *issue_list;		/* list for request issue */
+	struct ckpt_req *dispatch_list;		/* list for request dispatch */
+	spinlock_t issue_lock;			/* for issue list lock */
+	struct ckpt_req *issue_tail;		/* list tail of issue list */
+
+	/* updated by the checkpoint thread only */
+	unsigned int issued_ckpt;		/* # of merged checkpoints */
+	unsigned int total_req;			/* # of served requests */
+	unsigned int peak_time;			/* max. request latency in ms */
+	unsigned long long total_time;		/* sum of latencies in ms */
+};
+
+/* file classes for the F2FS_IPU_ADAPTIVE policy */
+enum {
+	IPU_CLASS_HOT,
+	IPU_CLASS_WARM,
+	IPU_CLASS_COLD,
+	NR_IPU_CLASS,
+};
+
 struct f2fs_sm_info {
 	struct sit_info *sit_info;		/* whole segment information */
 	struct free_segmap_info *free_info;	/* free segment information */
@@ -611,10 +655,14 @@ struct f2fs_sm_info {
 	unsigned int ipu_policy;	/* in-place-update policy */
 	unsigned int min_ipu_util;	/* in-place-update threshold */
 	unsigned int min_fsync_blocks;	/* threshold for fsync */
+	unsigned int hot_data_age;	/* rewrite age of hot data in seconds */
 
 	/* for flush command control */
 	struct flush_cmd_control *cmd_control_info;
 
+	/* for F2FS_IPU_ADAPTIVE policy */
+	struct ipu_adaptive_info *ipu_info;
+
 };
 
 /*
@@ -666,6 +714,7 @@ struct f2fs_io_info {
 	block_t blk_addr;	/* block address to be written */
 	struct page *page;	/* page to be written */
 	struct page *encrypted_page;	/* encrypted page */
+	bool is_ipu;		/* in-place update of data */
 };
 
 #define is_read_io(rw)	(((rw) & 1) == READ)
@@ -720,6 +769,8 @@ struct f2fs_sb_info {
 	struct rw_semaphore node_write;		/* locking node writes */
 	struct mutex writepages;		/* mutex for writepages() */
 	wait_queue_head_t cp_wait;
+	struct ckpt_req_control *cprc_info;	/* for checkpoint merge */
+	struct rw_semaphore cprc_rwsem;		/* protect cprc_info lifetime */
 
 	struct inode_management im[MAX_INO_ENTRY];      /* manage inode cache */
 
@@ -755,6 +806,7 @@ struct f2fs_sb_info {
 	unsigned int total_valid_inode_count;	/* valid inode count */
 	int active_logs;			/* # of active logs */
 	int dir_level;				/* directory level */
+	int readdir_ra;				/* readahead inodes in readdir */
 
 	block_t user_block_count;		/* # of user blocks */
 	block_t total_valid_block_count;	/* # of valid blocks */
@@ -1594,6 +1646,7 @@ void set_de_type(struct f2fs_dir_entry *, umode_t);
 struct f2fs_dir_entry *find_target_dentry(struct f2fs_filename *,
 			f2fs_hash_t, int *, struct f2fs_dentry_ptr *,
 			unsigned int flags);
+void f2fs_ra_dentry_page_inodes(struct inode *, struct page *, nid_t);
 bool f2fs_fill_dentries(struct file *, void *, filldir_t,
 			struct f2fs_dentry_ptr *, unsigned int, unsigned int, struct f2fs_str *);
 void do_make_empty_dir(struct inode *, struct inode *,
@@ -1657,6 +1710,7 @@ void remove_inode_page(struct inode *);
 struct page *new_inode_page(struct inode *);
 struct page *new_node_page(struct dnode_of_data *, unsigned int, struct page *);
 void ra_node_page(struct f2fs_sb_info *, nid_t);
+void ra_node_pages(struct f2fs_sb_info *, nid_t *, int);
 struct page *get_node_page(struct f2fs_sb_info *, pgoff_t);
 struct page *get_node_page_ra(struct page *, int);
 void sync_inode_page(struct dnode_of_data *);
@@ -1687,6 +1741,10 @@ int create_flush_cmd_control(struct f2fs_sb_info *);
 void destroy_flush_cmd_control(struct f2fs_sb_info *);
 void invalidate_blocks(struct f2fs_sb_info *, block_t);
 void refresh_sit_entry(struct f2fs_sb_info *, block_t, block_t);
+void update_data_temperature(struct inode *, block_t);
+bool need_adaptive_ipu(struct inode *);
+void start_ipu_latency_sample(struct f2fs_sb_info *, struct bio *, bool);
+void end_ipu_latency_sample(struct f2fs_sb_info *, struct bio *);
 void clear_prefree_segments(struct f2fs_sb_info *, struct cp_control *);
 void release_discard_addrs(struct f2fs_sb_info *);
 void discard_next_dnode(struct f2fs_sb_info *, block_t);
@@ -1738,6 +1796,9 @@ void add_dirty_dir_inode(struct inode *);
 void remove_dirty_dir_inode(struct inode *);
 void sync_dirty_dir_inodes(struct f2fs_sb_info *);
 void write_checkpoint(struct f2fs_sb_info *, struct cp_control *);
+void f2fs_issue_checkpoint(struct f2fs_sb_info *);
+int create_ckpt_req_control(struct f2fs_sb_info *);
+void destroy_ckpt_req_control(struct f2fs_sb_info *);
 void init_ino_entry_info(struct f2fs_sb_info *);
 int __init create_checkpoint_caches(void);
 void destroy_checkpoint_caches(void);
@@ -1814,6 +1875,13 @@ struct f2fs_stat_info {
 	unsigned int segment_count[2];
 	unsigned int block_count[2];
 	unsigned int inplace_count;
+	unsigned int cp_merge_issued, cp_merge_reqs;
+	unsigned int cp_merge_peak, cp_merge_avg;
+	unsigned int ipu_lat, opu_lat, ipu_samples, opu_samples;
+	int free_secs_trend;
+	bool ipu_class_on[NR_IPU_CLASS];
+	unsigned int ipu_class_ipu[NR_IPU_CLASS];
+	unsigned int ipu_class_opu[NR_IPU_CLASS];
 	unsigned base_mem, cache_mem, page_mem;
 };
 
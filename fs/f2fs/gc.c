@@ -243,6 +243,49 @@ static inline unsigned int get_gc_cost(struct f2fs_sb_info *sbi,
 		return get_cb_cost(sbi, segno);
 }
 
+/*
+ * LFS victim selection picks sections from the victim index instead of
+ * scanning the dirty segmap. Greedy stops at the lowest non-empty bucket,
+ * while cost-benefit compares the oldest few sections of every bucket.
+ */
+static void get_victim_from_index(struct f2fs_sb_info *sbi,
+			int gc_type, struct victim_sel_policy *p)
+{
+	struct dirty_seglist_info *dirty_i = DIRTY_I(sbi);
+	struct victim_index *vi = &dirty_i->vindex;
+	unsigned int bucket;
+
+	for_each_set_bit(bucket, vi->bucket_map, NR_VICTIM_BUCKETS) {
+		struct victim_entry *ve;
+		int nscanned = 0;
+
+		list_for_each_entry(ve, &vi->buckets[bucket], list) {
+			unsigned int secno = ve - vi->entries;
+			unsigned int segno = secno * sbi->segs_per_sec;
+			unsigned int cost;
+
+			if (sec_usage_check(sbi, secno))
+				continue;
+			if (gc_type == BG_GC &&
+					test_bit(secno, dirty_i->victim_secmap))
+				continue;
+
+			cost = get_gc_cost(sbi, segno, p);
+			if (p->min_cost > cost) {
+				p->min_segno = segno;
+				p->min_cost = cost;
+			}
+
+			if (++nscanned >= VICTIM_SCAN_PER_BUCKET)
+				break;
+		}
+
+		/* the next buckets have sections with more valid blocks */
+		if (p->gc_mode == GC_GREEDY && p->min_segno != NULL_SEGNO)
+			break;
+	}
+}
+
 /*
  * This function is called from two paths.
  * One is garbage collection and the other is SSR segment selection.
@@ -273,6 +316,11 @@ static int get_victim_by_default(struct f2fs_sb_info *sbi,
 			goto got_it;
 	}
 
+	if (p.alloc_mode == LFS) {
+		get_victim_from_index(sbi, gc_type, &p);
+		goto out;
+	}
+
 	while (1) {
 		unsigned long cost;
 		unsigned int segno;
@@ -312,6 +360,7 @@ static int get_victim_by_default(struct f2fs_sb_info *sbi,
 			break;
 		}
 	}
+out:
 	if (p.min_segno != NULL_SEGNO) {
 got_it:
 		if (p.alloc_mode == LFS) {
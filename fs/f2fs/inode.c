@@ -135,6 +135,7 @@ static int do_read_inode(struct inode *inode)
 	fi->i_flags = le32_to_cpu(ri->i_flags);
 	fi->flags = 0;
 	fi->i_advise = ri->i_advise;
+	fi->i_hot_score = file_is_hot(inode) ? HOT_DATA_SCORE_SET : 0;
 	fi->i_pino = le32_to_cpu(ri->i_pino);
 	fi->i_dir_level = ri->i_dir_level;
 
@@ -113,6 +113,33 @@ static inline void set_cold_files(struct f2fs_sb_info *sbi, struct inode *inode,
 	}
 }
 
+/*
+ * Files rewritten right after being written, like SQLite journals, start in
+ * the hot data log instead of waiting to be learned as hot
+ */
+static const char *hot_extensions[] = {
+	"db-journal",
+	"db-wal",
+	NULL
+};
+
+static inline void set_hot_files(struct inode *inode,
+		const unsigned char *name)
+{
+	int i;
+
+	if (file_is_cold(inode))
+		return;
+
+	for (i = 0; hot_extensions[i]; i++) {
+		if (is_multimedia_file(name, hot_extensions[i])) {
+			file_set_hot(inode);
+			F2FS_I(inode)->i_hot_score = HOT_DATA_SCORE_SET;
+			break;
+		}
+	}
+}
+
 static int f2fs_create(struct inode *dir, struct dentry *dentry, int mode,
 		       struct nameidata *nd)
 {
@@ -127,8 +154,10 @@ static int f2fs_create(struct inode *dir, struct dentry *dentry, int mode,
 	if (IS_ERR(inode))
 		return PTR_ERR(inode);
 
-	if (!test_opt(sbi, DISABLE_EXT_IDENTIFY))
+	if (!test_opt(sbi, DISABLE_EXT_IDENTIFY)) {
 		set_cold_files(sbi, inode, dentry->d_name.name);
+		set_hot_files(inode, dentry->d_name.name);
+	}
 
 	inode->i_op = &f2fs_file_inode_operations;
 	inode->i_fop = &f2fs_file_operations;
@@ -253,6 +282,7 @@ static struct dentry *f2fs_lookup(struct inode *dir, struct dentry *dentry,
 		return d_splice_alias(inode, dentry);
 
 	ino = le32_to_cpu(de->ino);
+	f2fs_ra_dentry_page_inodes(dir, page, ino);
 	f2fs_dentry_kunmap(dir, page);
 	f2fs_put_page(page, 0);
 
@@ -15,6 +15,7 @@
 #include <linux/blkdev.h>
 #include <linux/pagevec.h>
 #include <linux/swap.h>
+#include <linux/sort.h>
 
 #include "f2fs.h"
 #include "node.h"
@@ -1047,6 +1048,77 @@ void ra_node_page(struct f2fs_sb_info *sbi, nid_t nid)
 		f2fs_put_page(apage, 1);
 }
 
+struct ra_node_entry {
+	nid_t nid;
+	block_t blk_addr;
+};
+
+static int cmp_ra_node_entry(const void *a, const void *b)
+{
+	const struct ra_node_entry *ea = a, *eb = b;
+
+	if (ea->blk_addr == eb->blk_addr)
+		return 0;
+	return ea->blk_addr < eb->blk_addr ? -1 : 1;
+}
+
+/*
+ * Readahead a batch of node pages. The reads are issued in the order of
+ * their block addresses, so that contiguous node blocks are merged into
+ * a single bio instead of going out one by one as ra_node_page() does.
+ */
+void ra_node_pages(struct f2fs_sb_info *sbi, nid_t *nids, int count)
+{
+	struct ra_node_entry ra[MAX_RA_DENTRY_NODE];
+	struct f2fs_io_info fio = {
+		.sbi = sbi,
+		.type = NODE,
+		.rw = READA,
+		.encrypted_page = NULL,
+	};
+	struct node_info ni;
+	struct page *page;
+	int i, nr_ra = 0;
+
+	for (i = 0; i < count && nr_ra < MAX_RA_DENTRY_NODE; i++) {
+		page = find_get_page(NODE_MAPPING(sbi), nids[i]);
+		if (page && PageUptodate(page)) {
+			f2fs_put_page(page, 0);
+			continue;
+		}
+		f2fs_put_page(page, 0);
+
+		get_node_info(sbi, nids[i], &ni);
+		if (ni.blk_addr == NULL_ADDR || ni.blk_addr == NEW_ADDR)
+			continue;
+
+		ra[nr_ra].nid = nids[i];
+		ra[nr_ra].blk_addr = ni.blk_addr;
+		nr_ra++;
+	}
+
+	if (!nr_ra)
+		return;
+
+	sort(ra, nr_ra, sizeof(struct ra_node_entry), cmp_ra_node_entry, NULL);
+
+	for (i = 0; i < nr_ra; i++) {
+		page = grab_cache_page(NODE_MAPPING(sbi), ra[i].nid);
+		if (!page)
+			continue;
+		if (PageUptodate(page)) {
+			f2fs_put_page(page, 1);
+			continue;
+		}
+
+		fio.page = page;
+		fio.blk_addr = ra[i].blk_addr;
+		f2fs_submit_page_mbio(&fio);
+		f2fs_put_page(page, 0);
+	}
+	f2fs_submit_merged_bio(sbi, NODE, READ);
+}
+
 struct page *get_node_page(struct f2fs_sb_info *sbi, pgoff_t nid)
 {
 	struct page *page;
@@ -20,6 +20,9 @@
 /* maximum readahead size for node during getting data blocks */
 #define MAX_RA_NODE		128
 
+/* # of inode pages to readahead at once for the entries of a dentry block */
+#define MAX_RA_DENTRY_NODE	32
+
 /* control the memory footprint threshold (10MB per 1GB ram) */
 #define DEF_RAM_THRESHOLD	10
 
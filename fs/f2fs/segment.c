@@ -457,6 +457,54 @@ void destroy_flush_cmd_control(struct f2fs_sb_info *sbi)
 	SM_I(sbi)->cmd_control_info = NULL;
 }
 
+static inline struct victim_entry *get_victim_entry(struct f2fs_sb_info *sbi,
+						unsigned int segno)
+{
+	return &DIRTY_I(sbi)->vindex.entries[GET_SECNO(sbi, segno)];
+}
+
+static unsigned short get_victim_bucket(struct f2fs_sb_info *sbi,
+						unsigned int segno)
+{
+	unsigned int blks_per_sec = sbi->segs_per_sec << sbi->log_blocks_per_seg;
+	unsigned int vblocks = get_valid_blocks(sbi, segno, sbi->segs_per_sec);
+
+	if (vblocks >= blks_per_sec)
+		return NR_VICTIM_BUCKETS - 1;
+	return vblocks * NR_VICTIM_BUCKETS / blks_per_sec;
+}
+
+/*
+ * Move the section of a given segment into the victim bucket matching its
+ * current # of valid blocks, or drop it from the index if it has no dirty
+ * segments any more. This is called whenever the dirty state or the valid
+ * blocks of a segment change, with seglist_lock held.
+ */
+static void __update_victim_index(struct f2fs_sb_info *sbi, unsigned int segno)
+{
+	struct victim_index *vi = &DIRTY_I(sbi)->vindex;
+	struct victim_entry *ve = get_victim_entry(sbi, segno);
+	unsigned short bucket = NULL_VICTIM_BUCKET;
+
+	if (ve->nr_dirty)
+		bucket = get_victim_bucket(sbi, segno);
+
+	if (ve->bucket != NULL_VICTIM_BUCKET) {
+		list_del(&ve->list);
+		if (list_empty(&vi->buckets[ve->bucket]))
+			__clear_bit(ve->bucket, vi->bucket_map);
+		vi->nr_indexed--;
+	}
+
+	ve->bucket = bucket;
+	if (bucket == NULL_VICTIM_BUCKET)
+		return;
+
+	list_add_tail(&ve->list, &vi->buckets[bucket]);
+	__set_bit(bucket, vi->bucket_map);
+	vi->nr_indexed++;
+}
+
 static void __locate_dirty_segment(struct f2fs_sb_info *sbi, unsigned int segno,
 		enum dirty_type dirty_type)
 {
@@ -466,13 +514,18 @@ static void __locate_dirty_segment(struct f2fs_sb_info *sbi, unsigned int segno,
 	if (IS_CURSEG(sbi, segno))
 		return;
 
-	if (!test_and_set_bit(segno, dirty_i->dirty_segmap[dirty_type]))
+	if (!test_and_set_bit(segno, dirty_i->dirty_segmap[dirty_type])) {
 		dirty_i->nr_dirty[dirty_type]++;
+		if (dirty_type == DIRTY)
+			get_victim_entry(sbi, segno)->nr_dirty++;
+	}
 
 	if (dirty_type == DIRTY) {
 		struct seg_entry *sentry = get_seg_entry(sbi, segno);
 		enum dirty_type t = sentry->type;
 
+		__update_victim_index(sbi, segno);
+
 		if (unlikely(t >= DIRTY)) {
 			f2fs_bug_on(sbi, 1);
 			return;
@@ -487,13 +540,18 @@ static void __remove_dirty_segment(struct f2fs_sb_info *sbi, unsigned int segno,
 {
 	struct dirty_seglist_info *dirty_i = DIRTY_I(sbi);
 
-	if (test_and_clear_bit(segno, dirty_i->dirty_segmap[dirty_type]))
+	if (test_and_clear_bit(segno, dirty_i->dirty_segmap[dirty_type])) {
 		dirty_i->nr_dirty[dirty_type]--;
+		if (dirty_type == DIRTY)
+			get_victim_entry(sbi, segno)->nr_dirty--;
+	}
 
 	if (dirty_type == DIRTY) {
 		struct seg_entry *sentry = get_seg_entry(sbi, segno);
 		enum dirty_type t = sentry->type;
 
+		__update_victim_index(sbi, segno);
+
 		if (test_and_clear_bit(segno, dirty_i->dirty_segmap[t]))
 			dirty_i->nr_dirty[t]--;
 
@@ -778,6 +836,190 @@ void refresh_sit_entry(struct f2fs_sb_info *sbi, block_t old, block_t new)
 	locate_dirty_segment(sbi, GET_SEGNO(sbi, new));
 }
 
+/*
+ * Called before a data block of a regular file is rewritten. The age of the
+ * old block is taken from the mtime of its segment, and the learned hot bit
+ * lives in i_advise, so it is kept in the inode and exposed through the
+ * system.advise xattr.
+ */
+void update_data_temperature(struct inode *inode, block_t old_blkaddr)
+{
+	struct f2fs_sb_info *sbi = F2FS_I_SB(inode);
+	struct f2fs_inode_info *fi = F2FS_I(inode);
+	unsigned long long mtime;
+
+	if (!S_ISREG(inode->i_mode) || file_is_cold(inode))
+		return;
+	if (old_blkaddr == NEW_ADDR || old_blkaddr == NULL_ADDR)
+		return;
+
+	/* no sentry_lock here, a stale mtime only misleads one sample */
+	mtime = get_seg_entry(sbi, GET_SEGNO(sbi, old_blkaddr))->mtime;
+
+	if (mtime + SM_I(sbi)->hot_data_age > get_mtime(sbi)) {
+		if (fi->i_hot_score < HOT_DATA_SCORE_MAX)
+			fi->i_hot_score++;
+	} else if (fi->i_hot_score) {
+		fi->i_hot_score--;
+	}
+
+	if (!file_is_hot(inode) && fi->i_hot_score >= HOT_DATA_SCORE_SET) {
+		file_set_hot(inode);
+		mark_inode_dirty(inode);
+	} else if (file_is_hot(inode) && !fi->i_hot_score) {
+		file_clear_hot(inode);
+		mark_inode_dirty(inode);
+	}
+}
+
+static const unsigned int ipu_lat_ratio[NR_IPU_CLASS] = {
+	[IPU_CLASS_HOT]		= 150,
+	[IPU_CLASS_WARM]	= 100,
+	[IPU_CLASS_COLD]	= 0,
+};
+
+static inline int get_ipu_class(struct inode *inode)
+{
+	if (file_is_cold(inode))
+		return IPU_CLASS_COLD;
+	if (file_is_hot(inode))
+		return IPU_CLASS_HOT;
+	return IPU_CLASS_WARM;
+}
+
+static void update_adaptive_ipu(struct f2fs_sb_info *sbi)
+{
+	struct ipu_adaptive_info *ai = SM_I(sbi)->ipu_info;
+	unsigned int free_secs = free_sections(sbi);
+	unsigned long flags;
+	bool shrinking, explore;
+	int class;
+
+	if (!spin_trylock_irqsave(&ai->lock, flags))
+		return;
+	if (time_before(jiffies, ai->next_epoch))
+		goto out;
+
+	ai->next_epoch = jiffies + IPU_ADAPTIVE_EPOCH;
+	ai->epochs++;
+	ai->free_secs_trend = (int)free_secs - (int)ai->last_free_secs;
+	ai->last_free_secs = free_secs;
+
+	shrinking = ai->free_secs_trend < 0 &&
+			utilization(sbi) > SM_I(sbi)->min_ipu_util;
+	explore = ++ai->idle_epochs >= IPU_EXPLORE_EPOCHS;
+	if (explore)
+		ai->idle_epochs = 0;
+
+	for (class = 0; class < NR_IPU_CLASS; class++) {
+		bool use_ipu;
+
+		if (need_SSR(sbi))
+			use_ipu = true;
+		else if (shrinking && class != IPU_CLASS_COLD)
+			use_ipu = true;
+		else if (!ai->ipu_samples || !ai->opu_samples)
+			use_ipu = false;
+		else
+			use_ipu = ai->ipu_lat * 100 <=
+					ai->opu_lat * ipu_lat_ratio[class];
+
+		if (explore && class == IPU_CLASS_HOT)
+			use_ipu = true;
+		ai->use_ipu[class] = use_ipu;
+	}
+out:
+	spin_unlock_irqrestore(&ai->lock, flags);
+}
+
+bool need_adaptive_ipu(struct inode *inode)
+{
+	struct f2fs_sb_info *sbi = F2FS_I_SB(inode);
+	struct ipu_adaptive_info *ai = SM_I(sbi)->ipu_info;
+	int class = get_ipu_class(inode);
+
+	if (time_after_eq(jiffies, ai->next_epoch))
+		update_adaptive_ipu(sbi);
+
+	if (ai->use_ipu[class]) {
+		ai->nr_ipu[class]++;
+		return true;
+	}
+	ai->nr_opu[class]++;
+	return false;
+}
+
+/*
+ * Only one data write bio is sampled at a time, so that the latency feedback
+ * costs nothing but a pointer check for the other bios.
+ */
+void start_ipu_latency_sample(struct f2fs_sb_info *sbi, struct bio *bio,
+							bool is_ipu)
+{
+	struct ipu_adaptive_info *ai = SM_I(sbi)->ipu_info;
+	unsigned long flags;
+
+	if (!(SM_I(sbi)->ipu_policy & (0x1 << F2FS_IPU_ADAPTIVE)))
+		return;
+	if (ai->sample_bio)
+		return;
+
+	spin_lock_irqsave(&ai->lock, flags);
+	if (!ai->sample_bio) {
+		ai->sample_bio = bio;
+		ai->sample_start = ktime_get();
+		ai->sample_ipu = is_ipu;
+	}
+	spin_unlock_irqrestore(&ai->lock, flags);
+}
+
+static inline void update_ewma(unsigned int *avg, unsigned int *samples,
+							unsigned int val)
+{
+	*avg = (*samples)++ ? (*avg * 7 + val) >> 3 : val;
+}
+
+void end_ipu_latency_sample(struct f2fs_sb_info *sbi, struct bio *bio)
+{
+	struct ipu_adaptive_info *ai = SM_I(sbi)->ipu_info;
+	unsigned long flags;
+	unsigned int lat;
+
+	if (ai->sample_bio != bio)
+		return;
+
+	spin_lock_irqsave(&ai->lock, flags);
+	if (ai->sample_bio != bio)
+		goto out;
+
+	lat = ktime_us_delta(ktime_get(), ai->sample_start);
+	lat /= max_t(unsigned int, bio->bi_vcnt, 1);
+
+	if (ai->sample_ipu) {
+		update_ewma(&ai->ipu_lat, &ai->ipu_samples, lat);
+		ai->idle_epochs = 0;
+	} else {
+		update_ewma(&ai->opu_lat, &ai->opu_samples, lat);
+	}
+	ai->sample_bio = NULL;
+out:
+	spin_unlock_irqrestore(&ai->lock, flags);
+}
+
+static int build_ipu_adaptive_info(struct f2fs_sb_info *sbi)
+{
+	struct ipu_adaptive_info *ai;
+
+	ai = kzalloc(sizeof(struct ipu_adaptive_info), GFP_KERNEL);
+	if (!ai)
+		return -ENOMEM;
+
+	spin_lock_init(&ai->lock);
+	ai->next_epoch = jiffies;
+	SM_I(sbi)->ipu_info = ai;
+	return 0;
+}
+
 void invalidate_blocks(struct f2fs_sb_info *sbi, block_t addr)
 {
 	unsigned int segno = GET_SEGNO(sbi, addr);
@@ -1227,6 +1469,8 @@ static int __get_segment_type_6(struct page *page, enum page_type p_type)
 			return CURSEG_HOT_DATA;
 		else if (is_cold_data(page) || file_is_cold(inode))
 			return CURSEG_COLD_DATA;
+		else if (file_is_hot(inode))
+			return CURSEG_HOT_DATA;
 		else
 			return CURSEG_WARM_DATA;
 	} else {
@@ -2210,10 +2454,28 @@ static int init_victim_secmap(struct f2fs_sb_info *sbi)
 	return 0;
 }
 
+static int init_victim_index(struct f2fs_sb_info *sbi)
+{
+	struct victim_index *vi = &DIRTY_I(sbi)->vindex;
+	unsigned int secno;
+	int i;
+
+	vi->entries = vzalloc(MAIN_SECS(sbi) * sizeof(struct victim_entry));
+	if (!vi->entries)
+		return -ENOMEM;
+
+	for (i = 0; i < NR_VICTIM_BUCKETS; i++)
+		INIT_LIST_HEAD(&vi->buckets[i]);
+	for (secno = 0; secno < MAIN_SECS(sbi); secno++)
+		vi->entries[secno].bucket = NULL_VICTIM_BUCKET;
+	return 0;
+}
+
 static int build_dirty_segmap(struct f2fs_sb_info *sbi)
 {
 	struct dirty_seglist_info *dirty_i;
 	unsigned int bitmap_size, i;
+	int err;
 
 	/* allocate memory for dirty segments list information */
 	dirty_i = kzalloc(sizeof(struct dirty_seglist_info), GFP_KERNEL);
@@ -2231,6 +2493,10 @@ static int build_dirty_segmap(struct f2fs_sb_info *sbi)
 			return -ENOMEM;
 	}
 
+	err = init_victim_index(sbi);
+	if (err)
+		return err;
+
 	init_dirty_segmap(sbi);
 	return init_victim_secmap(sbi);
 }
@@ -2288,6 +2554,7 @@ int build_segment_manager(struct f2fs_sb_info *sbi)
 	sm_info->ipu_policy = 1 << F2FS_IPU_FSYNC;
 	sm_info->min_ipu_util = DEF_MIN_IPU_UTIL;
 	sm_info->min_fsync_blocks = DEF_MIN_FSYNC_BLOCKS;
+	sm_info->hot_data_age = DEF_HOT_DATA_AGE;
 
 	INIT_LIST_HEAD(&sm_info->discard_list);
 	sm_info->nr_discards = 0;
@@ -2303,6 +2570,9 @@ int build_segment_manager(struct f2fs_sb_info *sbi)
 			return err;
 	}
 
+	err = build_ipu_adaptive_info(sbi);
+	if (err)
+		return err;
 	err = build_sit_info(sbi);
 	if (err)
 		return err;
@@ -2355,6 +2625,7 @@ static void destroy_dirty_segmap(struct f2fs_sb_info *sbi)
 		discard_dirty_segmap(sbi, i);
 
 	destroy_victim_secmap(sbi);
+	vfree(dirty_i->vindex.entries);
 	SM_I(sbi)->dirty_info = NULL;
 	kfree(dirty_i);
 }
@@ -2420,6 +2691,7 @@ void destroy_segment_manager(struct f2fs_sb_info *sbi)
 	destroy_curseg(sbi);
 	destroy_free_segmap(sbi);
 	destroy_sit_info(sbi);
+	kfree(sm_info->ipu_info);
 	sbi->sm_info = NULL;
 	kfree(sm_info);
 }
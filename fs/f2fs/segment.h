@@ -227,12 +227,36 @@ enum dirty_type {
 	NR_DIRTY_TYPE
 };
 
+/*
+ * Dirty sections are indexed by their # of valid blocks, so that LFS victim
+ * selection does not need to scan the whole dirty segmap. Each bucket keeps
+ * its sections in the order of their last update, which means the head of a
+ * bucket is the oldest one.
+ */
+#define NR_VICTIM_BUCKETS	64
+#define NULL_VICTIM_BUCKET	((unsigned short)(~0))
+#define VICTIM_SCAN_PER_BUCKET	8	/* # of candidates checked per bucket */
+
+struct victim_entry {
+	struct list_head list;		/* link in a victim bucket */
+	unsigned short bucket;		/* bucket # or NULL_VICTIM_BUCKET */
+	unsigned short nr_dirty;	/* # of dirty segments in the section */
+};
+
+struct victim_index {
+	struct victim_entry *entries;		/* section-level entries */
+	struct list_head buckets[NR_VICTIM_BUCKETS];
+	DECLARE_BITMAP(bucket_map, NR_VICTIM_BUCKETS);	/* non-empty buckets */
+	unsigned int nr_indexed;		/* # of indexed sections */
+};
+
 struct dirty_seglist_info {
 	const struct victim_selection *v_ops;	/* victim selction operation */
 	unsigned long *dirty_segmap[NR_DIRTY_TYPE];
 	struct mutex seglist_lock;		/* lock for segment bitmaps */
 	int nr_dirty[NR_DIRTY_TYPE];		/* # of dirty segments */
 	unsigned long *victim_secmap;		/* background GC victims */
+	struct victim_index vindex;		/* dirty sections by cost */
 };
 
 /* victim selection function for cleaning and SSR */
@@ -493,10 +517,13 @@ static inline int utilization(struct f2fs_sb_info *sbi)
  * F2FS_IPU_FSYNC - activated in fsync path only for high performance flash
  *                     storages. IPU will be triggered only if the # of dirty
  *                     pages over min_fsync_blocks.
+ * F2FS_IPU_ADAPTIVE - decided per hot/warm/cold file class from the measured
+ *                     write latencies and the trend of free sections.
  * F2FS_IPUT_DISABLE - disable IPU. (=default option)
  */
 #define DEF_MIN_IPU_UTIL	70
 #define DEF_MIN_FSYNC_BLOCKS	8
+#define DEF_HOT_DATA_AGE	30	/* in seconds, see HOT_DATA_SCORE_SET */
 
 enum {
 	F2FS_IPU_FORCE,
@@ -504,6 +531,38 @@ enum {
 	F2FS_IPU_UTIL,
 	F2FS_IPU_SSR_UTIL,
 	F2FS_IPU_FSYNC,
+	F2FS_IPU_ADAPTIVE,
+};
+
+/*
+ * The adaptive policy re-evaluates its decisions once per epoch. IPU is
+ * chosen for a class when the per-page latency of in-place writes is within
+ * ipu_lat_ratio[class] percent of out-of-place ones, or, regardless of the
+ * latencies, when free sections keep shrinking over min_ipu_util. If no IPU
+ * write was sampled for IPU_EXPLORE_EPOCHS, hot files try IPU for an epoch.
+ */
+#define IPU_ADAPTIVE_EPOCH	HZ
+#define IPU_EXPLORE_EPOCHS	16
+
+struct ipu_adaptive_info {
+	spinlock_t lock;		/* also taken from bio completion */
+	unsigned long next_epoch;	/* jiffies of the next re-evaluation */
+	unsigned int epochs;		/* # of evaluated epochs */
+	unsigned int idle_epochs;	/* # of epochs with no IPU sample */
+	unsigned int last_free_secs;	/* free sections at the last epoch */
+	int free_secs_trend;		/* change of free sections per epoch */
+	bool use_ipu[NR_IPU_CLASS];	/* decision per file class */
+
+	/* write latency is sampled on one bio at a time */
+	struct bio *sample_bio;		/* bio being sampled */
+	ktime_t sample_start;		/* submission time of sample_bio */
+	bool sample_ipu;		/* sample_bio is an in-place update */
+	unsigned int ipu_lat, opu_lat;	/* per-page latency average in usec */
+	unsigned int ipu_samples, opu_samples;
+
+	/* decision counters */
+	unsigned int nr_ipu[NR_IPU_CLASS];
+	unsigned int nr_opu[NR_IPU_CLASS];
 };
 
 static inline bool need_inplace_update(struct inode *inode)
@@ -531,6 +590,9 @@ static inline bool need_inplace_update(struct inode *inode)
 			is_inode_flag_set(F2FS_I(inode), FI_NEED_IPU))
 		return true;
 
+	if (policy & (0x1 << F2FS_IPU_ADAPTIVE))
+		return need_adaptive_ipu(inode);
+
 	return false;
 }
 
@@ -60,6 +60,7 @@ enum {
 	Opt_fastboot,
 	Opt_extent_cache,
 	Opt_noinline_data,
+	Opt_checkpoint_merge,
 	Opt_err,
 };
 
@@ -84,6 +85,7 @@ static match_table_t f2fs_tokens = {
 	{Opt_fastboot, "fastboot"},
 	{Opt_extent_cache, "extent_cache"},
 	{Opt_noinline_data, "noinline_data"},
+	{Opt_checkpoint_merge, "checkpoint_merge"},
 	{Opt_err, NULL},
 };
 
@@ -205,9 +207,11 @@ F2FS_RW_ATTR(SM_INFO, f2fs_sm_info, batched_trim_sections, trim_sections);
 F2FS_RW_ATTR(SM_INFO, f2fs_sm_info, ipu_policy, ipu_policy);
 F2FS_RW_ATTR(SM_INFO, f2fs_sm_info, min_ipu_util, min_ipu_util);
 F2FS_RW_ATTR(SM_INFO, f2fs_sm_info, min_fsync_blocks, min_fsync_blocks);
+F2FS_RW_ATTR(SM_INFO, f2fs_sm_info, hot_data_age, hot_data_age);
 F2FS_RW_ATTR(NM_INFO, f2fs_nm_info, ram_thresh, ram_thresh);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, max_victim_search, max_victim_search);
 F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, dir_level, dir_level);
+F2FS_RW_ATTR(F2FS_SBI, f2fs_sb_info, readdir_ra, readdir_ra);
 
 #define ATTR_LIST(name) (&f2fs_attr_##name.attr)
 static struct attribute *f2fs_attrs[] = {
@@ -221,8 +225,10 @@ static struct attribute *f2fs_attrs[] = {
 	ATTR_LIST(ipu_policy),
 	ATTR_LIST(min_ipu_util),
 	ATTR_LIST(min_fsync_blocks),
+	ATTR_LIST(hot_data_age),
 	ATTR_LIST(max_victim_search),
 	ATTR_LIST(dir_level),
+	ATTR_LIST(readdir_ra),
 	ATTR_LIST(ram_thresh),
 	NULL,
 };
@@ -390,6 +396,9 @@ static int parse_options(struct super_block *sb, char *options)
 		case Opt_noinline_data:
 			clear_opt(sbi, INLINE_DATA);
 			break;
+		case Opt_checkpoint_merge:
+			set_opt(sbi, CP_MERGE);
+			break;
 		default:
 			f2fs_msg(sb, KERN_ERR,
 				"Unrecognized mount option \"%s\" or missing value",
@@ -415,6 +424,7 @@ static struct inode *f2fs_alloc_inode(struct super_block *sb)
 	atomic_set(&fi->dirty_pages, 0);
 	fi->i_current_depth = 1;
 	fi->i_advise = 0;
+	fi->i_hot_score = 0;
 	rwlock_init(&fi->ext_lock);
 	init_rwsem(&fi->i_sem);
 	INIT_RADIX_TREE(&fi->inmem_root, GFP_NOFS);
@@ -502,6 +512,7 @@ static void f2fs_put_super(struct super_block *sb)
 
 	f2fs_destroy_stats(sbi);
 	stop_gc_thread(sbi);
+	destroy_ckpt_req_control(sbi);
 
 	/*
 	 * We don't need to do checkpoint when superblock is clean.
@@ -546,13 +557,7 @@ int f2fs_sync_fs(struct super_block *sb, int sync)
 	trace_f2fs_sync_fs(sb, sync);
 
 	if (sync) {
-		struct cp_control cpc;
-
-		cpc.reason = __get_cp_reason(sbi);
-
-		mutex_lock(&sbi->gc_mutex);
-		write_checkpoint(sbi, &cpc);
-		mutex_unlock(&sbi->gc_mutex);
+		f2fs_issue_checkpoint(sbi);
 	} else {
 		f2fs_balance_fs(sbi);
 	}
@@ -649,6 +654,8 @@ static int f2fs_show_options(struct seq_file *seq, struct vfsmount *vfs)
 		seq_puts(seq, ",fastboot");
 	if (test_opt(sbi, EXTENT_CACHE))
 		seq_puts(seq, ",extent_cache");
+	if (!f2fs_readonly(sbi->sb) && test_opt(sbi, CP_MERGE))
+		seq_puts(seq, ",checkpoint_merge");
 	seq_printf(seq, ",active_logs=%u", sbi->active_logs);
 
 	return 0;
@@ -771,6 +778,18 @@ static int f2fs_remount(struct super_block *sb, int *flags, char *data)
 		if (err)
 			goto restore_gc;
 	}
+
+	/*
+	 * We stop the checkpoint merge thread if FS is mounted as RO
+	 * or if checkpoint_merge is not passed in mount option.
+	 */
+	if ((*flags & MS_RDONLY) || !test_opt(sbi, CP_MERGE)) {
+		destroy_ckpt_req_control(sbi);
+	} else if (!sbi->cprc_info) {
+		err = create_ckpt_req_control(sbi);
+		if (err)
+			goto restore_gc;
+	}
 skip:
 	/* Update the POSIXACL Flag */
 	 sb->s_flags = (sb->s_flags & ~MS_POSIXACL) |
@@ -1149,6 +1168,7 @@ try_onemore:
 	}
 
 	init_rwsem(&sbi->cp_rwsem);
+	init_rwsem(&sbi->cprc_rwsem);
 	init_waitqueue_head(&sbi->cp_wait);
 	init_sb_info(sbi);
 
@@ -1277,6 +1297,12 @@ try_onemore:
 		}
 	}
 
+	if (test_opt(sbi, CP_MERGE) && !f2fs_readonly(sb)) {
+		err = create_ckpt_req_control(sbi);
+		if (err)
+			goto free_kobj;
+	}
+
 	/*
 	 * If filesystem is not mounted as read-only then
 	 * do start the gc_thread.
@@ -1285,7 +1311,7 @@ try_onemore:
 		/* After POR, we can run background GC thread.*/
 		err = start_gc_thread(sbi);
 		if (err)
-			goto free_kobj;
+			goto free_ckpt;
 	}
 	kfree(options);
 
@@ -1297,6 +1323,8 @@ try_onemore:
 
 	return 0;
 
+free_ckpt:
+	destroy_ckpt_req_control(sbi);
 free_kobj:
 	kobject_del(&sbi->s_kobj);
 free_proc:
@@ -437,6 +437,12 @@ void end_writeback(struct inode *inode)
 	spin_lock_irq(&inode->i_data.tree_lock);
 	BUG_ON(inode->i_data.nrpages);
 	spin_unlock_irq(&inode->i_data.tree_lock);
+	/*
+	 * No page is left to be evicted, so no new shadow entry can
+	 * appear: drop the ones truncation did not get to.
+	 */
+	if (inode->i_data.nrshadows)
+		clear_shadow_entries(&inode->i_data, 0, ULONG_MAX);
 	BUG_ON(!list_empty(&inode->i_data.private_list));
 	BUG_ON(!(inode->i_state & I_FREEING));
 	BUG_ON(inode->i_state & I_CLEAR);
@@ -584,6 +584,14 @@ static int show_smap(struct seq_file *m, void *v, int is_pid)
 		   (vma->vm_flags & VM_LOCKED) ?
 			(unsigned long)(mss.pss >> (10 + PSS_SHIFT)) : 0);
 
+#ifdef CONFIG_KSM
+	if (vma->vm_flags & VM_MERGEABLE)
+		seq_printf(m,
+			   "KsmScanned:     %8lu\n"
+			   "KsmMerged:      %8lu\n",
+			   vma->ksm_scanned, vma->ksm_merged);
+#endif
+
 	if (vma_get_anon_name(vma)) {
 		seq_puts(m, "Name:           ");
 		seq_print_vma_name(m, vma);
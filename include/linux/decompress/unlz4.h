@@ -7,4 +7,8 @@ int unlz4(unsigned char *inbuf, int len,
 	unsigned char *output,
 	int *pos,
 	void(*error)(char *x));
+
+#ifdef CONFIG_DECOMPRESS_LZ4_PARALLEL
+extern int unlz4_nr_workers;
+#endif
 #endif
@@ -648,6 +648,7 @@ struct address_space {
 	struct mutex		i_mmap_mutex;	/* protect tree, count, list */
 	/* Protected by tree_lock together with the radix tree */
 	unsigned long		nrpages;	/* number of total pages */
+	unsigned long		nrshadows;	/* number of shadow entries */
 	pgoff_t			writeback_index;/* writeback starts here */
 	const struct address_space_operations *a_ops;	/* methods */
 	unsigned long		flags;		/* error bits/gfp mask */
@@ -927,6 +928,11 @@ struct file_ra_state {
 	unsigned int ra_pages;		/* Maximum readahead window */
 	unsigned int mmap_miss;		/* Cache miss stat for mmap accesses */
 	loff_t prev_pos;		/* Cache last read() position */
+
+	unsigned int stride;		/* pages skipped between read requests */
+	unsigned char pattern;		/* access pattern, see mm/readahead.c */
+	unsigned char hits;		/* sequential windows used in a row */
+	unsigned char misses;		/* random cache misses in a row */
 };
 
 /*
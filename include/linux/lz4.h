@@ -12,6 +12,26 @@
 #define LZ4_MEM_COMPRESS	(4096 * sizeof(unsigned char *))
 #define LZ4HC_MEM_COMPRESS	(65538 * sizeof(unsigned char *))
 
+/*
+ * Acceleration trades compression ratio for speed: each step above the
+ * default makes the match finder skip ahead faster over incompressible
+ * input.  Values outside [1, LZ4_ACCELERATION_MAX] are clamped.
+ */
+#define LZ4_ACCELERATION_DEFAULT	1
+#define LZ4_ACCELERATION_MAX		65537
+
+/*
+ * Streaming compression state.  Blocks compressed through the same
+ * stream may reference up to 64KB of the data that precedes them, as
+ * long as that data directly precedes the new block in memory.
+ */
+struct lz4_stream {
+	unsigned long hashtable[LZ4_MEM_COMPRESS / sizeof(unsigned long)];
+	const unsigned char *base;
+	const unsigned char *dict;
+	unsigned int dict_size;
+};
+
 /*
  * lz4_compressbound()
  * Provides the maximum size that LZ4 may output in a "worst case" scenario
@@ -39,6 +59,48 @@ static inline size_t lz4_compressbound(size_t isize)
 int lz4_compress(const unsigned char *src, size_t src_len,
 		unsigned char *dst, size_t *dst_len, void *wrkmem);
 
+/*
+ * lz4_compress_fast()
+ *	Same as lz4_compress(), with an additional 'acceleration' factor.
+ *	lz4_compress() is lz4_compress_fast() with LZ4_ACCELERATION_DEFAULT.
+ */
+int lz4_compress_fast(const unsigned char *src, size_t src_len,
+		unsigned char *dst, size_t *dst_len, void *wrkmem,
+		int acceleration);
+
+/*
+ * lz4_stream_reset()
+ *	Drops any history held by 'stream'.  Must be called before the
+ *	first use of a stream.
+ */
+void lz4_stream_reset(struct lz4_stream *stream);
+
+/*
+ * lz4_loaddict()
+ *	Primes 'stream' with a dictionary.  Only the last 64KB are used.
+ *	The dictionary must stay in place, and the first block compressed
+ *	afterwards must directly follow it in memory.
+ *	return  : the number of dictionary bytes retained
+ */
+int lz4_loaddict(struct lz4_stream *stream, const unsigned char *dict,
+		size_t dict_size);
+
+/*
+ * lz4_compress_continue()
+ *	src, src_len, dst, dst_len : as for lz4_compress()
+ *	acceleration : as for lz4_compress_fast()
+ *	return  : Success if return 0
+ *		  Error if return (< 0)
+ *	note :  'src' may reference the dictionary or the blocks previously
+ *		compressed through 'stream' if it directly follows them in
+ *		memory.  Otherwise the history is dropped and 'src' is
+ *		compressed on its own.  The output must be decompressed with
+ *		lz4_decompress_continue().
+ */
+int lz4_compress_continue(struct lz4_stream *stream,
+		const unsigned char *src, size_t src_len,
+		unsigned char *dst, size_t *dst_len, int acceleration);
+
  /*
   * lz4hc_compress()
   *	 src	 : source address of the original data
@@ -84,4 +146,16 @@ int lz4_decompress(const unsigned char *src, size_t *src_len,
  */
 int lz4_decompress_unknownoutputsize(const unsigned char *src, size_t src_len,
 		unsigned char *dest, size_t *dest_len);
+
+/*
+ * lz4_decompress_continue()
+ *	src, src_len, dest, dest_len : as for lz4_decompress_unknownoutputsize()
+ *	prefix_size : number of bytes directly preceding 'dest' that hold
+ *		previously decompressed data (or the dictionary), and may be
+ *		referenced by the block.  At most 64KB are ever used.
+ *	return  : Success if return 0
+ *		  Error if return (< 0)
+ */
+int lz4_decompress_continue(const unsigned char *src, size_t src_len,
+		unsigned char *dest, size_t *dest_len, size_t prefix_size);
 #endif
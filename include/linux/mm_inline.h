@@ -21,10 +21,206 @@ static inline int page_is_file_cache(struct page *page)
 	return !PageSwapBacked(page);
 }
 
+#ifdef CONFIG_LRU_GEN
+
+#include <linux/memcontrol.h>
+
+#define LRU_GEN_CORE		0x1	/* keep pages on the multi-gen LRU */
+#define LRU_GEN_MM_WALK		0x2	/* kswapd ages by page table walks */
+
+extern unsigned int lru_gen_state;
+
+/*
+ * The memory controller keeps pages on per-cgroup lists of its own, which
+ * the multi-gen LRU does not maintain: it only takes effect when the
+ * controller is disabled, or not built.
+ */
+static inline bool lru_gen_enabled(void)
+{
+	return (lru_gen_state & LRU_GEN_CORE) && mem_cgroup_disabled();
+}
+
+static inline int lru_gen_from_seq(unsigned long seq)
+{
+	return seq % MAX_NR_GENS;
+}
+
+/*
+ * Returns the generation @page is in, or -1 if it is not on the
+ * multi-gen LRU.
+ */
+static inline int page_lru_gen(struct page *page)
+{
+	return (int)((page->flags & LRU_GEN_MASK) >> LRU_GEN_PGOFF) - 1;
+}
+
+/*
+ * The other page flags change without zone->lru_lock, so the generation,
+ * which only changes with it held, is still updated atomically.
+ */
+static inline void set_page_lru_gen(struct page *page, int gen)
+{
+	unsigned long old, new;
+
+	do {
+		old = ACCESS_ONCE(page->flags);
+		new = (old & ~LRU_GEN_MASK) |
+		      ((unsigned long)(gen + 1) << LRU_GEN_PGOFF);
+	} while (cmpxchg(&page->flags, old, new) != old);
+}
+
+/* The two youngest generations are accounted as active, the rest not. */
+static inline bool lru_gen_is_active(struct zone *zone, int gen)
+{
+	unsigned long max_seq = zone->lrugen.max_seq;
+
+	return gen == lru_gen_from_seq(max_seq) ||
+	       gen == lru_gen_from_seq(max_seq - 1);
+}
+
+/*
+ * Move @page from generation @old_gen to @new_gen in the page counts,
+ * where -1 stands for a page entering or leaving the multi-gen LRU.
+ */
+static inline void lru_gen_update_size(struct zone *zone, struct page *page,
+				       int old_gen, int new_gen)
+{
+	struct lru_gen_struct *lrugen = &zone->lrugen;
+	int type = page_is_file_cache(page);
+	int delta = hpage_nr_pages(page);
+	enum lru_list l = type ? LRU_INACTIVE_FILE : LRU_INACTIVE_ANON;
+
+	if (old_gen >= 0) {
+		lrugen->nr_pages[old_gen][type] -= delta;
+		__mod_zone_page_state(zone, NR_LRU_BASE + l +
+			(lru_gen_is_active(zone, old_gen) ? LRU_ACTIVE : 0),
+			-delta);
+	}
+	if (new_gen >= 0) {
+		lrugen->nr_pages[new_gen][type] += delta;
+		__mod_zone_page_state(zone, NR_LRU_BASE + l +
+			(lru_gen_is_active(zone, new_gen) ? LRU_ACTIVE : 0),
+			delta);
+	}
+}
+
+static inline bool lru_gen_add_page(struct zone *zone, struct page *page,
+				    enum lru_list l)
+{
+	struct lru_gen_struct *lrugen = &zone->lrugen;
+	int type = page_is_file_cache(page);
+	unsigned long seq;
+	int gen;
+
+	if (!lru_gen_enabled() || l == LRU_UNEVICTABLE)
+		return false;
+
+	VM_BUG_ON(page_lru_gen(page) != -1);
+
+	/*
+	 * Pages found in use go to the youngest generation.  Anon pages
+	 * that are not in the swap cache were not read back from swap
+	 * for reclaim and get one generation more than the rest, which
+	 * start out in the oldest one, like the inactive list.
+	 */
+	if (PageActive(page))
+		seq = lrugen->max_seq;
+	else if (type == LRU_GEN_ANON && !PageSwapCache(page))
+		seq = lrugen->min_seq[type] + 1;
+	else
+		seq = lrugen->min_seq[type];
+	gen = lru_gen_from_seq(seq);
+
+	ClearPageActive(page);
+	set_page_lru_gen(page, gen);
+	lru_gen_update_size(zone, page, -1, gen);
+	list_add(&page->lru, &lrugen->lists[gen][type]);
+
+	return true;
+}
+
+/*
+ * A page that is taken off for a while, for migration say, rather than
+ * for reclaim or for good, is marked active if it was young, so that
+ * it goes back to the youngest generation.
+ */
+static inline bool lru_gen_del_page(struct zone *zone, struct page *page,
+				    bool isolating)
+{
+	int gen = page_lru_gen(page);
+
+	if (gen < 0)
+		return false;
+
+	VM_BUG_ON(PageActive(page));
+	VM_BUG_ON(PageUnevictable(page));
+
+	list_del(&page->lru);
+	lru_gen_update_size(zone, page, gen, -1);
+	set_page_lru_gen(page, -1);
+	if (isolating && lru_gen_is_active(zone, gen))
+		SetPageActive(page);
+
+	return true;
+}
+
+/* Make @page the next one to be reclaimed. */
+static inline bool lru_gen_move_tail(struct zone *zone, struct page *page)
+{
+	struct lru_gen_struct *lrugen = &zone->lrugen;
+	int gen = page_lru_gen(page);
+	int type = page_is_file_cache(page);
+	int new_gen;
+
+	if (gen < 0)
+		return false;
+
+	new_gen = lru_gen_from_seq(lrugen->min_seq[type]);
+	lru_gen_update_size(zone, page, gen, new_gen);
+	set_page_lru_gen(page, new_gen);
+	list_move_tail(&page->lru, &lrugen->lists[new_gen][type]);
+
+	return true;
+}
+
+#else /* !CONFIG_LRU_GEN */
+
+static inline bool lru_gen_enabled(void)
+{
+	return false;
+}
+
+static inline int page_lru_gen(struct page *page)
+{
+	return -1;
+}
+
+static inline bool lru_gen_add_page(struct zone *zone, struct page *page,
+				    enum lru_list l)
+{
+	return false;
+}
+
+static inline bool lru_gen_del_page(struct zone *zone, struct page *page,
+				    bool isolating)
+{
+	return false;
+}
+
+static inline bool lru_gen_move_tail(struct zone *zone, struct page *page)
+{
+	return false;
+}
+
+#endif /* CONFIG_LRU_GEN */
+
 static inline void
 __add_page_to_lru_list(struct zone *zone, struct page *page, enum lru_list l,
 		       struct list_head *head)
 {
+	if (lru_gen_add_page(zone, page, l))
+		return;
+
 	list_add(&page->lru, head);
 	__mod_zone_page_state(zone, NR_LRU_BASE + l, hpage_nr_pages(page));
 	mem_cgroup_add_lru_list(page, l);
@@ -39,6 +235,9 @@ add_page_to_lru_list(struct zone *zone, struct page *page, enum lru_list l)
 static inline void
 del_page_from_lru_list(struct zone *zone, struct page *page, enum lru_list l)
 {
+	if (lru_gen_del_page(zone, page, true))
+		return;
+
 	list_del(&page->lru);
 	__mod_zone_page_state(zone, NR_LRU_BASE + l, -hpage_nr_pages(page));
 	mem_cgroup_del_lru_list(page, l);
@@ -64,6 +263,9 @@ del_page_from_lru(struct zone *zone, struct page *page)
 {
 	enum lru_list l;
 
+	if (lru_gen_del_page(zone, page, false))
+		return;
+
 	list_del(&page->lru);
 	if (PageUnevictable(page)) {
 		__ClearPageUnevictable(page);
@@ -216,6 +216,31 @@ struct vm_area_struct {
 #ifdef CONFIG_NUMA
 	struct mempolicy *vm_policy;	/* NUMA policy for the VMA */
 #endif
+#ifdef CONFIG_SWAP
+	atomic_long_t swap_readahead_info; /* last fault, window and hits */
+#endif
+#ifdef CONFIG_KSM
+	unsigned long ksm_scanned;	/* pages scanned by ksmd */
+	unsigned long ksm_merged;	/* pages merged by ksmd */
+	unsigned long ksm_merged_mark;	/* ksm_merged at last due scan */
+	unsigned int ksm_idle_scans;	/* scans in a row merging nothing */
+#endif
+};
+
+#define PAGE_FRAG_CACHE_MAX_SIZE	__ALIGN_MASK(32768, ~PAGE_MASK)
+#define PAGE_FRAG_CACHE_MAX_ORDER	get_order(PAGE_FRAG_CACHE_MAX_SIZE)
+
+/*
+ * A page, high order if one can be had, being carved into fragments by
+ * __alloc_page_frag().  Instead of taking a page reference for every
+ * fragment, a large bias is added to the page count when the page is
+ * set up, and pagecnt_bias counts down the part of it not handed out.
+ */
+struct page_frag_cache {
+	void *va;			/* start of the page */
+	unsigned int offset;		/* fragments are carved downwards */
+	unsigned int size;		/* of the page */
+	unsigned int pagecnt_bias;	/* references not yet handed out */
 };
 
 struct core_thread {
@@ -275,6 +300,11 @@ struct mm_struct {
 						 * together off init_mm.mmlist, and are protected
 						 * by mmlist_lock
 						 */
+#ifdef CONFIG_LRU_GEN
+	struct list_head lru_gen_list;		/* on lru_gen_mm_list, walked
+						 * to age the multi-gen LRU
+						 */
+#endif
 
 
 	unsigned long hiwater_rss;	/* High-watermark of RSS usage */
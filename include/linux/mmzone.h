@@ -35,6 +35,12 @@
  */
 #define PAGE_ALLOC_COSTLY_ORDER 3
 
+/*
+ * Blocks of up to PCP_MAX_ORDER are kept on the per-cpu lists as well as
+ * single pages, for task stacks, skb heads and the like.
+ */
+#define PCP_MAX_ORDER PAGE_ALLOC_COSTLY_ORDER
+
 #define MIGRATE_UNMOVABLE     0
 #define MIGRATE_RECLAIMABLE   1
 #define MIGRATE_MOVABLE       2
@@ -106,6 +112,8 @@ enum zone_stat_item {
 	NR_SHMEM,		/* shmem pages (included tmpfs/GEM pages) */
 	NR_DIRTIED,		/* page dirtyings since bootup */
 	NR_WRITTEN,		/* page writings since bootup */
+	WORKINGSET_REFAULT,	/* refaults of evicted file pages */
+	WORKINGSET_ACTIVATE,	/* refaulted pages that were activated */
 #ifdef CONFIG_NUMA
 	NUMA_HIT,		/* allocated in intended node */
 	NUMA_MISS,		/* allocated in non intended node */
@@ -194,6 +202,11 @@ struct per_cpu_pages {
 
 struct per_cpu_pageset {
 	struct per_cpu_pages pcp;
+	/*
+	 * Blocks of order 1 to PCP_MAX_ORDER, in pcp_order[order - 1]; their
+	 * count, high and batch are in blocks rather than pages.
+	 */
+	struct per_cpu_pages pcp_order[PCP_MAX_ORDER];
 #ifdef CONFIG_NUMA
 	s8 expire;
 #endif
@@ -289,6 +302,39 @@ struct zone_reclaim_stat {
 	unsigned long		recent_scanned[2];
 };
 
+#ifdef CONFIG_LRU_GEN
+/*
+ * The multi-gen LRU keeps the evictable pages of a zone on lists by
+ * generation and type (anon or file) instead of on the active and
+ * inactive lists; see the comment above lru_gen_shrink_zone() in
+ * mm/vmscan.c.  Generations are numbered by an ever increasing sequence
+ * number, and a page's generation, seq % MAX_NR_GENS, is kept in
+ * page->flags.
+ */
+#define MIN_NR_GENS		2
+#define MAX_NR_GENS		4
+#define LRU_GEN_WIDTH		3	/* holds MAX_NR_GENS + 1 values */
+
+#define LRU_GEN_ANON		0
+#define LRU_GEN_FILE		1
+#define ANON_AND_FILE		2
+
+struct lru_gen_struct {
+	/* the youngest generation, activated pages go here */
+	unsigned long		max_seq;
+	/* the oldest generation of each type, reclaim takes from here */
+	unsigned long		min_seq[ANON_AND_FILE];
+	/* when each generation was started, in jiffies */
+	unsigned long		timestamps[MAX_NR_GENS];
+	/* pages are sorted onto these lazily, see lru_gen_isolate() */
+	struct list_head	lists[MAX_NR_GENS][ANON_AND_FILE];
+	/* pages by the generation in their page->flags */
+	long			nr_pages[MAX_NR_GENS][ANON_AND_FILE];
+};
+#else
+#define LRU_GEN_WIDTH		0
+#endif
+
 struct zone {
 	/* Fields commonly accessed by the page allocator */
 
@@ -359,6 +405,9 @@ struct zone {
 	} lru[NR_LRU_LISTS];
 
 	struct zone_reclaim_stat reclaim_stat;
+#ifdef CONFIG_LRU_GEN
+	struct lru_gen_struct	lrugen;
+#endif
 
 	unsigned long		pages_scanned;	   /* since last reclaim */
 	unsigned long		flags;		   /* zone flags, see below */
@@ -372,6 +421,8 @@ struct zone {
 	 */
 	unsigned int inactive_ratio;
 
+	/* Evictions & activations on the inactive file list */
+	atomic_long_t		inactive_age;
 
 	ZONE_PADDING(_pad2_)
 	/* Rarely used or read-mostly fields */
@@ -649,6 +700,13 @@ typedef struct pglist_data {
 	wait_queue_head_t kswapd_wait;
 	struct task_struct *kswapd;	/* Protected by lock_memory_hotplug() */
 	int kswapd_max_order;
+#ifdef CONFIG_COMPACTION
+	wait_queue_head_t kcompactd_wait;
+	struct task_struct *kcompactd;	/* Protected by lock_memory_hotplug() */
+	bool kcompactd_wake;
+	unsigned int kcompactd_backoff;	/* failed runs in a row */
+	unsigned long kcompactd_next;	/* not woken again before this */
+#endif
 	enum zone_type classzone_idx;
 } pg_data_t;
 
@@ -787,6 +845,10 @@ int lowmem_reserve_ratio_sysctl_handler(struct ctl_table *, int,
 					void __user *, size_t *, loff_t *);
 int percpu_pagelist_fraction_sysctl_handler(struct ctl_table *, int,
 					void __user *, size_t *, loff_t *);
+extern int percpu_pagelist_order_high[PCP_MAX_ORDER];
+extern int percpu_pagelist_order_batch[PCP_MAX_ORDER];
+int percpu_pagelist_order_sysctl_handler(struct ctl_table *, int,
+					void __user *, size_t *, loff_t *);
 int sysctl_min_unmapped_ratio_sysctl_handler(struct ctl_table *, int,
 			void __user *, size_t *, loff_t *);
 int sysctl_min_slab_ratio_sysctl_handler(struct ctl_table *, int,
@@ -204,6 +204,11 @@ struct swap_list_t {
 /* Swap 50% full? */
 #define vm_swap_full() (nr_swap_pages*2 < total_swap_pages)
 
+/* linux/mm/workingset.c */
+void *workingset_eviction(struct address_space *mapping, struct page *page);
+bool workingset_refault(void *shadow);
+void workingset_activation(struct page *page);
+
 /* linux/mm/page_alloc.c */
 extern unsigned long totalram_pages;
 extern unsigned long totalreserve_pages;
@@ -256,6 +261,28 @@ extern unsigned long mem_cgroup_shrink_node_zone(struct mem_cgroup *mem,
 						unsigned long *nr_scanned);
 extern int __isolate_lru_page(struct page *page, isolate_mode_t mode, int file);
 extern unsigned long shrink_all_memory(unsigned long nr_pages);
+#ifdef CONFIG_LRU_GEN
+extern void lru_gen_init_zone(struct zone *zone);
+static inline void lru_gen_init_mm(struct mm_struct *mm)
+{
+	INIT_LIST_HEAD(&mm->lru_gen_list);
+}
+extern void lru_gen_add_mm(struct mm_struct *mm);
+extern void lru_gen_del_mm(struct mm_struct *mm);
+#else
+static inline void lru_gen_init_zone(struct zone *zone)
+{
+}
+static inline void lru_gen_init_mm(struct mm_struct *mm)
+{
+}
+static inline void lru_gen_add_mm(struct mm_struct *mm)
+{
+}
+static inline void lru_gen_del_mm(struct mm_struct *mm)
+{
+}
+#endif
 extern int vm_swappiness;
 extern int remove_mapping(struct address_space *mapping, struct page *page);
 extern long vm_total_pages;
@@ -311,11 +338,16 @@ extern void __delete_from_swap_cache(struct page *);
 extern void delete_from_swap_cache(struct page *);
 extern void free_page_and_swap_cache(struct page *);
 extern void free_pages_and_swap_cache(struct page **, int);
-extern struct page *lookup_swap_cache(swp_entry_t);
+extern struct page *lookup_swap_cache(swp_entry_t,
+			struct vm_area_struct *vma, unsigned long addr);
 extern struct page *read_swap_cache_async(swp_entry_t, gfp_t,
 			struct vm_area_struct *vma, unsigned long addr);
 extern struct page *swapin_readahead(swp_entry_t, gfp_t,
 			struct vm_area_struct *vma, unsigned long addr);
+extern bool swap_vma_readahead_enabled;
+extern struct page *swap_vma_readahead(swp_entry_t, gfp_t,
+			struct vm_area_struct *vma, unsigned long addr,
+			pmd_t *pmd);
 
 /* linux/mm/swapfile.c */
 extern long nr_swap_pages;
@@ -425,12 +457,22 @@ static inline struct page *swapin_readahead(swp_entry_t swp, gfp_t gfp_mask,
 	return NULL;
 }
 
+#define swap_vma_readahead_enabled	false
+
+static inline struct page *swap_vma_readahead(swp_entry_t swp, gfp_t gfp_mask,
+			struct vm_area_struct *vma, unsigned long addr,
+			pmd_t *pmd)
+{
+	return NULL;
+}
+
 static inline int swap_writepage(struct page *p, struct writeback_control *wbc)
 {
 	return 0;
 }
 
-static inline struct page *lookup_swap_cache(swp_entry_t swp)
+static inline struct page *lookup_swap_cache(swp_entry_t swp,
+			struct vm_area_struct *vma, unsigned long addr)
 {
 	return NULL;
 }
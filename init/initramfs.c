@@ -410,6 +410,24 @@ static int __init flush_buffer(void *bufv, unsigned len)
 static unsigned my_inptr;   /* index of next byte to be processed in inbuf */
 
 #include <linux/decompress/generic.h>
+#include <linux/decompress/unlz4.h>
+#include <linux/hrtimer.h>
+
+/* One line per compressed image, to follow its share of the boot time */
+static void __init report_decompress(const char *compress_name,
+				     ktime_t start)
+{
+	int workers = 1;
+
+#ifdef CONFIG_DECOMPRESS_LZ4_PARALLEL
+	if (!strcmp(compress_name, "lz4"))
+		workers = unlz4_nr_workers;
+#endif
+	printk(KERN_INFO "initramfs: %s image decompressed in %lld us "
+	       "(%d worker%s)\n", compress_name,
+	       ktime_to_us(ktime_sub(ktime_get(), start)),
+	       workers, workers > 1 ? "s" : "");
+}
 
 static char * __init unpack_to_rootfs(char *buf, unsigned len)
 {
@@ -417,6 +435,7 @@ static char * __init unpack_to_rootfs(char *buf, unsigned len)
 	decompress_fn decompress;
 	const char *compress_name;
 	static __initdata char msg_buf[64];
+	ktime_t start;
 
 	header_buf = kmalloc(110, GFP_KERNEL);
 	symlink_buf = kmalloc(PATH_MAX + N_ALIGN(PATH_MAX) + 1, GFP_KERNEL);
@@ -446,10 +465,13 @@ static char * __init unpack_to_rootfs(char *buf, unsigned len)
 		this_header = 0;
 		decompress = decompress_method(buf, len, &compress_name);
 		if (decompress) {
+			start = ktime_get();
 			res = decompress(buf, len, NULL, flush_buffer, NULL,
 				   &my_inptr, error);
 			if (res)
 				error("decompressor failed");
+			else
+				report_decompress(compress_name, start);
 		} else if (compress_name) {
 			if (!message) {
 				snprintf(msg_buf, sizeof msg_buf,
@@ -41,6 +41,7 @@
 #include <linux/cpu.h>
 #include <linux/notifier.h>
 #include <linux/rculist.h>
+#include <linux/kthread.h>
 
 #include <asm/uaccess.h>
 
@@ -763,6 +764,23 @@ static int printk_time = 0;
 #endif
 module_param_named(time, printk_time, bool, S_IRUGO | S_IWUSR);
 
+#ifdef CONFIG_PRINTK_CONSOLE_THREAD
+/*
+ * Console output is handed to a kernel thread, so that printk() costs the
+ * caller a copy into log_buf rather than a pass through every (possibly
+ * very slow) console driver with interrupts off. The thread is woken from
+ * the timer tick, as printk() itself may be called with the runqueue lock
+ * held. Set printk.synchronous=1 to print from printk() as before.
+ */
+static struct task_struct *printk_thread;
+static DECLARE_WAIT_QUEUE_HEAD(printk_thread_wait);
+static int printk_synchronous;
+module_param_named(synchronous, printk_synchronous, bool, S_IRUGO | S_IWUSR);
+
+/* Largest piece of log_buf handed to the consoles with interrupts off */
+#define PRINTK_THREAD_CHUNK	256
+#endif
+
 /* Check if we have any console registered that can be called early in boot. */
 static int have_callable_console(void)
 {
@@ -867,6 +885,31 @@ static int console_trylock_for_printk(unsigned int cpu)
 	spin_unlock(&logbuf_lock);
 	return retval;
 }
+
+#ifdef CONFIG_PRINTK_CONSOLE_THREAD
+/*
+ * Can the console output of this printk() be left to printk_thread?
+ * Not if the system may never schedule it again: oopses, panics and
+ * the final messages of a reboot or halt are printed synchronously.
+ */
+static inline int printk_may_defer(void)
+{
+	if (!printk_thread || printk_synchronous || oops_in_progress)
+		return 0;
+	return system_state == SYSTEM_BOOTING ||
+	       system_state == SYSTEM_RUNNING;
+}
+#else
+static inline int printk_may_defer(void)
+{
+	return 0;
+}
+#endif
+
+static DEFINE_PER_CPU(int, printk_pending);
+
+#define PRINTK_PENDING_WAKEUP	0x01
+#define PRINTK_PENDING_CONSOLE	0x02
 static const char recursion_bug_msg [] =
 		KERN_CRIT "BUG: recent printk recursion!\n";
 static int recursion_bug;
@@ -1011,6 +1054,18 @@ asmlinkage int vprintk(const char *fmt, va_list args)
 			new_text_line = 1;
 	}
 
+	/*
+	 * If the consoles can be left to printk_thread, just
+	 * note that there is output for it; the next tick
+	 * wakes it up.
+	 */
+	if (printk_may_defer()) {
+		printk_cpu = UINT_MAX;
+		spin_unlock(&logbuf_lock);
+		this_cpu_or(printk_pending, PRINTK_PENDING_CONSOLE);
+		goto out;
+	}
+
 	/*
 	 * Try to acquire and then immediately release the
 	 * console semaphore. The release will do all the
@@ -1023,6 +1078,7 @@ asmlinkage int vprintk(const char *fmt, va_list args)
 	 */
 	if (console_trylock_for_printk(this_cpu))
 		console_unlock();
+out:
 
 	lockdep_on();
 out_restore_irqs:
@@ -1195,6 +1251,9 @@ void resume_console(void)
 	down(&console_sem);
 	console_suspended = 0;
 	console_unlock();
+#ifdef CONFIG_PRINTK_CONSOLE_THREAD
+	wake_up(&printk_thread_wait);
+#endif
 }
 
 /**
@@ -1268,14 +1327,20 @@ int is_console_locked(void)
 	return console_locked;
 }
 
-static DEFINE_PER_CPU(int, printk_pending);
-
 void printk_tick(void)
 {
-	if (__this_cpu_read(printk_pending)) {
-		__this_cpu_write(printk_pending, 0);
+	int pending;
+
+	if (!__this_cpu_read(printk_pending))
+		return;
+
+	pending = this_cpu_xchg(printk_pending, 0);
+#ifdef CONFIG_PRINTK_CONSOLE_THREAD
+	if ((pending & PRINTK_PENDING_CONSOLE) && printk_thread)
+		wake_up(&printk_thread_wait);
+#endif
+	if (pending & PRINTK_PENDING_WAKEUP)
 		wake_up_interruptible(&log_wait);
-	}
 }
 
 int printk_needs_cpu(int cpu)
@@ -1288,7 +1353,7 @@ int printk_needs_cpu(int cpu)
 void wake_up_klogd(void)
 {
 	if (waitqueue_active(&log_wait))
-		this_cpu_write(printk_pending, 1);
+		this_cpu_or(printk_pending, PRINTK_PENDING_WAKEUP);
 }
 
 /**
@@ -1325,12 +1390,25 @@ void console_unlock(void)
 			break;			/* Nothing to print */
 		_con_start = con_start;
 		_log_end = log_end;
-		con_start = log_end;		/* Flush */
+#ifdef CONFIG_PRINTK_CONSOLE_THREAD
+		/*
+		 * printk_thread prints in bounded pieces and lets
+		 * interrupts and other tasks in between them.
+		 */
+		if (current == printk_thread &&
+		    _log_end - _con_start > PRINTK_THREAD_CHUNK)
+			_log_end = _con_start + PRINTK_THREAD_CHUNK;
+#endif
+		con_start = _log_end;		/* Flush */
 		spin_unlock(&logbuf_lock);
 		stop_critical_timings();	/* don't trace print latency */
 		call_console_drivers(_con_start, _log_end);
 		start_critical_timings();
 		local_irq_restore(flags);
+#ifdef CONFIG_PRINTK_CONSOLE_THREAD
+		if (current == printk_thread)
+			cond_resched();
+#endif
 	}
 	console_locked = 0;
 
@@ -1345,6 +1423,65 @@ void console_unlock(void)
 }
 EXPORT_SYMBOL(console_unlock);
 
+#ifdef CONFIG_PRINTK_CONSOLE_THREAD
+/*
+ * console_unlock() prints nothing while the consoles are suspended, so
+ * the thread must not be woken for it then: resume_console() wakes it.
+ * The thread is not freezable: with no_console_suspend, the messages of
+ * device suspend and resume must not wait for the thaw.
+ */
+static inline int printk_thread_pending(void)
+{
+	return con_start != log_end && !console_suspended;
+}
+
+static int printk_thread_func(void *unused)
+{
+	for (;;) {
+		wait_event_interruptible(printk_thread_wait,
+					 printk_thread_pending());
+
+		console_lock();
+		console_unlock();
+	}
+
+	return 0;
+}
+
+/*
+ * panic() clears oops_in_progress again before it prints its last
+ * messages, and the panicking CPU never schedules printk_thread.
+ */
+static int printk_panic_notify(struct notifier_block *nb,
+			       unsigned long event, void *unused)
+{
+	printk_synchronous = 1;
+	return NOTIFY_DONE;
+}
+
+static struct notifier_block printk_panic_nb = {
+	.notifier_call	= printk_panic_notify,
+	.priority	= INT_MAX,
+};
+
+static int __init printk_thread_init(void)
+{
+	struct task_struct *tsk;
+
+	atomic_notifier_chain_register(&panic_notifier_list, &printk_panic_nb);
+
+	tsk = kthread_run(printk_thread_func, NULL, "printk");
+	if (IS_ERR(tsk)) {
+		printk(KERN_ERR "printk: unable to start console thread\n");
+		return PTR_ERR(tsk);
+	}
+	printk_thread = tsk;
+
+	return 0;
+}
+early_initcall(printk_thread_init);
+#endif
+
 /**
  * console_conditional_schedule - yield the CPU if required
  *
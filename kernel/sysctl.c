@@ -271,6 +271,7 @@ static int max_sched_tunable_scaling = SCHED_TUNABLESCALING_END-1;
 #ifdef CONFIG_COMPACTION
 static int min_extfrag_threshold;
 static int max_extfrag_threshold = 1000;
+static int max_kcompactd_order = MAX_ORDER - 1;
 #endif
 
 static struct ctl_table kern_table[] = {
@@ -1209,6 +1210,24 @@ static struct ctl_table vm_table[] = {
 		.extra1		= &min_extfrag_threshold,
 		.extra2		= &max_extfrag_threshold,
 	},
+	{
+		.procname	= "kcompactd_order",
+		.data		= &sysctl_kcompactd_order,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &zero,
+		.extra2		= &max_kcompactd_order,
+	},
+	{
+		.procname	= "kcompactd_extfrag_threshold",
+		.data		= &sysctl_kcompactd_extfrag_threshold,
+		.maxlen		= sizeof(int),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &min_extfrag_threshold,
+		.extra2		= &max_extfrag_threshold,
+	},
 
 #endif /* CONFIG_COMPACTION */
 	{
@@ -1242,6 +1261,22 @@ static struct ctl_table vm_table[] = {
 		.proc_handler	= percpu_pagelist_fraction_sysctl_handler,
 		.extra1		= &min_percpu_pagelist_fract,
 	},
+	{
+		.procname	= "percpu_pagelist_order_high",
+		.data		= &percpu_pagelist_order_high,
+		.maxlen		= sizeof(percpu_pagelist_order_high),
+		.mode		= 0644,
+		.proc_handler	= percpu_pagelist_order_sysctl_handler,
+		.extra1		= &zero,
+	},
+	{
+		.procname	= "percpu_pagelist_order_batch",
+		.data		= &percpu_pagelist_order_batch,
+		.maxlen		= sizeof(percpu_pagelist_order_batch),
+		.mode		= 0644,
+		.proc_handler	= percpu_pagelist_order_sysctl_handler,
+		.extra1		= &zero,
+	},
 #ifdef CONFIG_MMU
 	{
 		.procname	= "max_map_count",
@@ -29,6 +29,11 @@
 #include <linux/crc32.h>
 #include <linux/module.h>
 #include <linux/types.h>
+#ifdef CONFIG_CRC32_AUTOSELECT
+#include <linux/hrtimer.h>
+#include <linux/math64.h>
+#include <linux/slab.h>
+#endif
 #include "crc32defs.h"
 
 #if CRC_LE_BITS > 8
@@ -49,11 +54,27 @@ MODULE_AUTHOR("Matt Domsch <Matt_Domsch@dell.com>");
 MODULE_DESCRIPTION("Various CRC32 calculations");
 MODULE_LICENSE("GPL");
 
+#ifdef CONFIG_CRC32_AUTOSELECT
+/*
+ * Bits per step of the variants picked by crc32_select(): 8 (Sarwate),
+ * 32 (slicing-by-4) or 64 (slicing-by-8), all on the slicing-by-8 tables.
+ */
+static int crc32_le_bits __read_mostly = CRC_LE_BITS;
+static int crc32_be_bits __read_mostly = CRC_BE_BITS;
+#else
+# define crc32_le_bits CRC_LE_BITS
+# define crc32_be_bits CRC_BE_BITS
+#endif
+
 #if CRC_LE_BITS > 8 || CRC_BE_BITS > 8
 
-/* implements slicing-by-4 or slicing-by-8 algorithm */
+/*
+ * implements slicing-by-4 or slicing-by-8 algorithm, or Sarwate's algorithm
+ * on the first table when @slice is 1
+ */
 static inline u32
-crc32_body(u32 crc, unsigned char const *buf, size_t len, const u32 (*tab)[256])
+crc32_body(u32 crc, unsigned char const *buf, size_t len, const u32 (*tab)[256],
+	   int slice)
 {
 # ifdef __LITTLE_ENDIAN
 #  define DO_CRC(x) (crc = t0[(crc ^ (x)) & 255] ^ (crc >> 8))
@@ -79,6 +100,12 @@ crc32_body(u32 crc, unsigned char const *buf, size_t len, const u32 (*tab)[256])
 #endif
 	u32 q;
 
+	if (slice == 1) {
+		while (len--)
+			DO_CRC(*buf++);
+		return crc;
+	}
+
 	/* Align it */
 	if (unlikely((long)buf & 3 && len)) {
 		do {
@@ -86,13 +113,13 @@ crc32_body(u32 crc, unsigned char const *buf, size_t len, const u32 (*tab)[256])
 		} while ((--len) && ((long)buf)&3);
 	}
 
-# if CRC_LE_BITS == 32
-	rem_len = len & 3;
-	len = len >> 2;
-# else
-	rem_len = len & 7;
-	len = len >> 3;
-# endif
+	if (slice == 4) {
+		rem_len = len & 3;
+		len = len >> 2;
+	} else {
+		rem_len = len & 7;
+		len = len >> 3;
+	}
 
 	b = (const u32 *)buf;
 # ifdef CONFIG_X86
@@ -105,9 +132,13 @@ crc32_body(u32 crc, unsigned char const *buf, size_t len, const u32 (*tab)[256])
 # if CRC_LE_BITS == 32
 		crc = DO_CRC4;
 # else
-		crc = DO_CRC8;
-		q = *++b;
-		crc ^= DO_CRC4;
+		if (slice == 4) {
+			crc = DO_CRC4;
+		} else {
+			crc = DO_CRC8;
+			q = *++b;
+			crc ^= DO_CRC4;
+		}
 # endif
 	}
 	len = rem_len;
@@ -170,7 +201,7 @@ static inline u32 __pure crc32_le_generic(u32 crc, unsigned char const *p,
 	}
 # else
 	crc = (__force u32) __cpu_to_le32(crc);
-	crc = crc32_body(crc, p, len, tab);
+	crc = crc32_body(crc, p, len, tab, crc32_le_bits / 8);
 	crc = __le32_to_cpu((__force __le32)crc);
 #endif
 	return crc;
@@ -229,7 +260,7 @@ static inline u32 __pure crc32_be_generic(u32 crc, unsigned char const *p,
 	}
 # else
 	crc = (__force u32) __cpu_to_be32(crc);
-	crc = crc32_body(crc, p, len, tab);
+	crc = crc32_body(crc, p, len, tab, crc32_be_bits / 8);
 	crc = __be32_to_cpu((__force __be32)crc);
 # endif
 	return crc;
@@ -241,6 +272,121 @@ u32 __pure crc32_be(u32 crc, unsigned char const *p, size_t len)
 }
 EXPORT_SYMBOL(crc32_be);
 
+#ifdef CONFIG_CRC32_AUTOSELECT
+
+#define CRC32_BENCH_SIZE	PAGE_SIZE
+#define CRC32_BENCH_LOOPS	16
+#define CRC32_BENCH_ROUNDS	3
+
+static const struct {
+	const char *name;
+	int bits;
+} crc32_variants[] = {
+	{ "slice-by-8",	64 },
+	{ "slice-by-4",	32 },
+	{ "sarwate",	8 },
+};
+
+/* keep the benchmarked calls from being optimised away */
+static u32 crc32_bench_sink __initdata;
+
+/*
+ * Time CRC32_BENCH_LOOPS passes over @buf with the variant currently
+ * selected by *@bits, keeping the best of a few rounds like
+ * do_xor_speed() does.  Returns MB/s, or 0 if the variant does not
+ * agree with slicing-by-8.
+ */
+static unsigned int __init crc32_speed(int *bits, int variant, u32 expected,
+				       u32 (*fn)(u32, unsigned char const *,
+						 size_t),
+				       const u8 *buf)
+{
+	s64 best = LLONG_MAX;
+	int i, j;
+
+	*bits = crc32_variants[variant].bits;
+	if (fn(~0, buf, CRC32_BENCH_SIZE) != expected)
+		return 0;
+
+	for (i = 0; i < CRC32_BENCH_ROUNDS; i++) {
+		ktime_t start;
+		s64 ns;
+
+		preempt_disable();
+		start = ktime_get();
+		for (j = 0; j < CRC32_BENCH_LOOPS; j++) {
+			crc32_bench_sink ^= fn(~0, buf, CRC32_BENCH_SIZE);
+			mb(); /* prevent loop optimzation */
+		}
+		ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+		preempt_enable();
+
+		if (ns < best)
+			best = ns;
+	}
+
+	/* bytes per ns * 1000 == MB/s */
+	return div64_s64((s64)CRC32_BENCH_SIZE * CRC32_BENCH_LOOPS * 1000,
+			 max_t(s64, best, 1));
+}
+
+static int __init crc32_select_one(const char *dir, int *bits,
+				   u32 (*fn)(u32, unsigned char const *,
+					     size_t),
+				   const u8 *buf)
+{
+	unsigned int speed, best_speed = 0;
+	int i, best = 0;
+	u32 expected;
+
+	*bits = crc32_variants[0].bits;
+	expected = fn(~0, buf, CRC32_BENCH_SIZE);
+
+	for (i = 0; i < ARRAY_SIZE(crc32_variants); i++) {
+		speed = crc32_speed(bits, i, expected, fn, buf);
+		if (!speed) {
+			pr_warn("crc32: %s %s gives wrong results, skipped\n",
+				crc32_variants[i].name, dir);
+			continue;
+		}
+		pr_info("crc32:    %-10s %s: %5u MB/sec\n",
+			crc32_variants[i].name, dir, speed);
+		if (speed > best_speed) {
+			best_speed = speed;
+			best = i;
+		}
+	}
+
+	*bits = crc32_variants[best].bits;
+	return best;
+}
+
+/* Pick the fastest variant for this CPU, separately for LE and BE */
+static void __init crc32_select(void)
+{
+	int le, be;
+	u8 *buf;
+	int i;
+
+	buf = kmalloc(CRC32_BENCH_SIZE, GFP_KERNEL);
+	if (!buf) {
+		pr_warn("crc32: no memory for benchmark, using %s\n",
+			crc32_variants[0].name);
+		return;
+	}
+	for (i = 0; i < CRC32_BENCH_SIZE; i++)
+		buf[i] = i * 0x9d + (i >> 8);
+
+	pr_info("crc32: measuring implementation speed\n");
+	le = crc32_select_one("le", &crc32_le_bits, crc32_le, buf);
+	be = crc32_select_one("be", &crc32_be_bits, crc32_be, buf);
+	pr_info("crc32: using %s (le), %s (be)\n",
+		crc32_variants[le].name, crc32_variants[be].name);
+
+	kfree(buf);
+}
+#endif /* CONFIG_CRC32_AUTOSELECT */
+
 #ifdef CONFIG_CRC32_SELFTEST
 
 /* 4096 random bytes */
@@ -1013,7 +1159,7 @@ static int __init crc32c_test(void)
 	nsec = stop.tv_nsec - start.tv_nsec +
 		1000000000 * (stop.tv_sec - start.tv_sec);
 
-	pr_info("crc32c: CRC_LE_BITS = %d\n", CRC_LE_BITS);
+	pr_info("crc32c: CRC_LE_BITS = %d\n", crc32_le_bits);
 
 	if (errors)
 		pr_warn("crc32c: %d self tests failed\n", errors);
@@ -1072,7 +1218,7 @@ static int __init crc32_test(void)
 		1000000000 * (stop.tv_sec - start.tv_sec);
 
 	pr_info("crc32: CRC_LE_BITS = %d, CRC_BE BITS = %d\n",
-		 CRC_LE_BITS, CRC_BE_BITS);
+		 crc32_le_bits, crc32_be_bits);
 
 	if (errors)
 		pr_warn("crc32: %d self tests failed\n", errors);
@@ -1090,11 +1236,24 @@ static int __init crc32test_init(void)
 	crc32c_test();
 	return 0;
 }
+#endif /* CONFIG_CRC32_SELFTEST */
+
+#if defined(CONFIG_CRC32_AUTOSELECT) || defined(CONFIG_CRC32_SELFTEST)
+static int __init crc32_init(void)
+{
+#ifdef CONFIG_CRC32_AUTOSELECT
+	crc32_select();
+#endif
+#ifdef CONFIG_CRC32_SELFTEST
+	crc32test_init();
+#endif
+	return 0;
+}
 
 static void __exit crc32_exit(void)
 {
 }
 
-module_init(crc32test_init);
+module_init(crc32_init);
 module_exit(crc32_exit);
-#endif /* CONFIG_CRC32_SELFTEST */
+#endif
@@ -13,6 +13,7 @@
 #include "lz4/lz4_decompress.c"
 #else
 #include <linux/decompress/unlz4.h>
+#include <linux/kernel.h>
 #endif
 #include <linux/types.h>
 #include <linux/lz4.h>
@@ -21,6 +22,14 @@
 
 #include <asm/unaligned.h>
 
+#if !defined(PREBOOT) && defined(CONFIG_DECOMPRESS_LZ4_PARALLEL)
+#define UNLZ4_PARALLEL
+#include <linux/completion.h>
+#include <linux/cpumask.h>
+#include <linux/slab.h>
+#include <linux/workqueue.h>
+#endif
+
 /*
  * Note: Uncompressed chunk size is used in the compressor side
  * (userspace side for compression).
@@ -31,6 +40,194 @@
 #define LZ4_DEFAULT_UNCOMPRESSED_CHUNK_SIZE (8 << 20)
 #define ARCHIVE_MAGICNUMBER 0x184C2102
 
+#ifdef UNLZ4_PARALLEL
+/*
+ * Every chunk of the legacy format is self-contained and is preceded by
+ * its compressed size, so an in-memory image can be indexed by walking
+ * the chunk headers and the chunks decoded concurrently.  Each worker
+ * owns one output window of LZ4_DEFAULT_UNCOMPRESSED_CHUNK_SIZE; with a
+ * caller-supplied output buffer the windows are the final locations of
+ * the chunks, otherwise they are flushed in order as they complete.
+ */
+#define UNLZ4_MAX_WORKERS	4
+/* Returned when the image is not suitable for parallel decoding */
+#define UNLZ4_SEQUENTIAL	1
+
+/* Workers used by the last unlz4() call, reported by initramfs.c */
+int unlz4_nr_workers;
+
+struct unlz4_chunk {
+	u8 *src;
+	size_t src_len;
+};
+
+struct unlz4_worker {
+	struct work_struct work;
+	struct completion done;
+	const struct unlz4_chunk *chunk;
+	u8 *buf;		/* private window, NULL with direct output */
+	u8 *dst;
+	size_t dst_len;
+	bool busy;
+	int ret;
+};
+
+/*
+ * Walk the chunk headers of an in-memory image.  Returns the number of
+ * chunks, filling in 'chunks' if non-NULL, or -1 if the image is not
+ * laid out exactly as the sequential decoder expects.
+ */
+static int INIT unlz4_index(u8 *inp, int size, struct unlz4_chunk *chunks,
+			    int *consumed)
+{
+	size_t max_chunksize = lz4_compressbound(
+			LZ4_DEFAULT_UNCOMPRESSED_CHUNK_SIZE);
+	int nr = 0;
+	int pos = 0;
+
+	if (size < 4 || get_unaligned_le32(inp) != ARCHIVE_MAGICNUMBER)
+		return -1;
+	pos += 4;
+
+	while (pos < size) {
+		size_t chunksize;
+
+		if (size - pos < 4)
+			return -1;
+		chunksize = get_unaligned_le32(inp + pos);
+		pos += 4;
+		if (chunksize == ARCHIVE_MAGICNUMBER)
+			continue;
+		if (!chunksize || chunksize > max_chunksize ||
+				chunksize > size - pos)
+			return -1;
+		if (chunks) {
+			chunks[nr].src = inp + pos;
+			chunks[nr].src_len = chunksize;
+		}
+		nr++;
+		pos += chunksize;
+	}
+
+	*consumed = pos;
+	return nr;
+}
+
+static void INIT unlz4_work(struct work_struct *work)
+{
+	struct unlz4_worker *w = container_of(work, struct unlz4_worker, work);
+
+	w->dst_len = LZ4_DEFAULT_UNCOMPRESSED_CHUNK_SIZE;
+	w->ret = lz4_decompress_unknownoutputsize(w->chunk->src,
+			w->chunk->src_len, w->dst, &w->dst_len);
+	complete(&w->done);
+}
+
+static void INIT unlz4_queue(struct unlz4_worker *w,
+			     const struct unlz4_chunk *chunk, u8 *output,
+			     int index)
+{
+	w->chunk = chunk;
+	w->dst = output ? output + (size_t)index *
+			LZ4_DEFAULT_UNCOMPRESSED_CHUNK_SIZE : w->buf;
+	w->busy = true;
+	INIT_COMPLETION(w->done);
+	queue_work(system_unbound_wq, &w->work);
+}
+
+/*
+ * Returns 0 on success, -1 on error, or UNLZ4_SEQUENTIAL if the caller
+ * should fall back to decoding one chunk at a time.
+ */
+static int INIT unlz4_parallel(u8 *input, int in_len,
+			       int (*flush) (void *, unsigned int),
+			       u8 *output, int *posp,
+			       void (*error) (char *x))
+{
+	struct unlz4_chunk *chunks;
+	struct unlz4_worker *workers;
+	int nr_chunks, nr_workers;
+	int consumed;
+	int i, ret = UNLZ4_SEQUENTIAL;
+
+	nr_chunks = unlz4_index(input, in_len, NULL, &consumed);
+	nr_workers = min_t(int, num_online_cpus(), UNLZ4_MAX_WORKERS);
+	nr_workers = min(nr_workers, nr_chunks);
+	if (nr_workers < 2)
+		return UNLZ4_SEQUENTIAL;
+
+	chunks = kmalloc(nr_chunks * sizeof(*chunks), GFP_KERNEL);
+	workers = kcalloc(nr_workers, sizeof(*workers), GFP_KERNEL);
+	if (!chunks || !workers)
+		goto out_free;
+	unlz4_index(input, in_len, chunks, &consumed);
+
+	for (i = 0; i < nr_workers; i++) {
+		INIT_WORK(&workers[i].work, unlz4_work);
+		init_completion(&workers[i].done);
+		if (output)
+			continue;
+		workers[i].buf = large_malloc(
+				LZ4_DEFAULT_UNCOMPRESSED_CHUNK_SIZE);
+		if (!workers[i].buf)
+			break;
+	}
+	/* Make do with the windows we got */
+	nr_workers = i;
+	if (nr_workers < 2)
+		goto out_bufs;
+
+	for (i = 0; i < nr_workers; i++)
+		unlz4_queue(&workers[i], &chunks[i], output, i);
+
+	ret = 0;
+	for (i = 0; i < nr_chunks; i++) {
+		struct unlz4_worker *w = &workers[i % nr_workers];
+
+		wait_for_completion(&w->done);
+		w->busy = false;
+
+		if (w->ret < 0) {
+			error("Decoding failed");
+			ret = -1;
+			break;
+		}
+		/* Only the last chunk may be short */
+		if (i != nr_chunks - 1 &&
+		    w->dst_len != LZ4_DEFAULT_UNCOMPRESSED_CHUNK_SIZE) {
+			error("data corrupted");
+			ret = -1;
+			break;
+		}
+		if (flush && flush(w->dst, w->dst_len) != w->dst_len) {
+			ret = -1;
+			break;
+		}
+
+		if (i + nr_workers < nr_chunks)
+			unlz4_queue(w, &chunks[i + nr_workers], output,
+				    i + nr_workers);
+	}
+
+	/* Drain whatever is still in flight after an error */
+	for (i = 0; i < nr_workers; i++)
+		if (workers[i].busy)
+			wait_for_completion(&workers[i].done);
+
+	if (!ret && posp)
+		*posp = consumed;
+	unlz4_nr_workers = nr_workers;
+
+out_bufs:
+	for (i = 0; i < nr_workers; i++)
+		large_free(workers[i].buf);
+out_free:
+	kfree(workers);
+	kfree(chunks);
+	return ret;
+}
+#endif /* UNLZ4_PARALLEL */
+
 STATIC inline int INIT unlz4(u8 *input, int in_len,
 				int (*fill) (void *, unsigned int),
 				int (*flush) (void *, unsigned int),
@@ -49,6 +246,17 @@ STATIC inline int INIT unlz4(u8 *input, int in_len,
 #endif
 	size_t dest_len;
 
+#ifdef UNLZ4_PARALLEL
+	unlz4_nr_workers = 1;
+	if (input && !fill) {
+		ret = unlz4_parallel(input, in_len, flush, output, posp,
+				     error);
+		if (ret != UNLZ4_SEQUENTIAL)
+			goto exit_0;
+		ret = -1;
+	}
+#endif
+
 
 	if (output) {
 		outp = output;
@@ -4,8 +4,6 @@
 #include <linux/slab.h>
 #include <linux/list.h>
 
-#define MAX_LIST_LENGTH_BITS 20
-
 /*
  * Returns a list organized in an intermediate format suited
  * to chaining of merge() calls: null-terminated, no reserved or
@@ -16,21 +14,29 @@ static struct list_head *merge(void *priv,
 					struct list_head *b),
 				struct list_head *a, struct list_head *b)
 {
-	struct list_head head, *tail = &head;
+	struct list_head *head, **tail = &head;
 
-	while (a && b) {
+	for (;;) {
 		/* if equal, take 'a' -- important for sort stability */
 		if ((*cmp)(priv, a, b) <= 0) {
-			tail->next = a;
+			*tail = a;
+			tail = &a->next;
 			a = a->next;
+			if (!a) {
+				*tail = b;
+				break;
+			}
 		} else {
-			tail->next = b;
+			*tail = b;
+			tail = &b->next;
 			b = b->next;
+			if (!b) {
+				*tail = a;
+				break;
+			}
 		}
-		tail = tail->next;
 	}
-	tail->next = a?:b;
-	return head.next;
+	return head;
 }
 
 /*
@@ -40,41 +46,52 @@ static struct list_head *merge(void *priv,
  * prev-link restoration pass, or maintaining the prev links
  * throughout.
  */
-static void merge_and_restore_back_links(void *priv,
-				int (*cmp)(void *priv, struct list_head *a,
-					struct list_head *b),
-				struct list_head *head,
-				struct list_head *a, struct list_head *b)
+static void merge_final(void *priv,
+			int (*cmp)(void *priv, struct list_head *a,
+				struct list_head *b),
+			struct list_head *head,
+			struct list_head *a, struct list_head *b)
 {
 	struct list_head *tail = head;
+	u8 count = 0;
 
-	while (a && b) {
+	for (;;) {
 		/* if equal, take 'a' -- important for sort stability */
 		if ((*cmp)(priv, a, b) <= 0) {
 			tail->next = a;
 			a->prev = tail;
+			tail = a;
 			a = a->next;
+			if (!a)
+				break;
 		} else {
 			tail->next = b;
 			b->prev = tail;
+			tail = b;
 			b = b->next;
+			if (!b) {
+				b = a;
+				break;
+			}
 		}
-		tail = tail->next;
 	}
-	tail->next = a ? : b;
 
+	/* Finish linking remainder of list b on to tail */
+	tail->next = b;
 	do {
 		/*
 		 * In worst cases this loop may run many iterations.
 		 * Continue callbacks to the client even though no
 		 * element comparison is needed, so the client's cmp()
 		 * routine can invoke cond_resched() periodically.
+		 * Once every 256 elements is plenty for that.
 		 */
-		(*cmp)(priv, tail->next, tail->next);
-
-		tail->next->prev = tail;
-		tail = tail->next;
-	} while (tail->next);
+		if (unlikely(!++count))
+			(*cmp)(priv, b, b);
+		b->prev = tail;
+		tail = b;
+		b = b->next;
+	} while (b);
 
 	tail->next = head;
 	head->prev = tail;
@@ -93,57 +110,98 @@ static void merge_and_restore_back_links(void *priv,
  * should sort before @b, and a positive value if @a should sort after
  * @b. If @a and @b are equivalent, and their original relative
  * ordering is to be preserved, @cmp must return 0.
+ *
+ * The sort is bottom-up. Sorted sublists are kept on a "pending" stack,
+ * linked through their first elements' prev pointers, and a count of the
+ * elements moved there so far decides when to merge: each time the count
+ * passes a multiple of 2^k, two pending sublists of 2^k elements are
+ * merged, but only once 2^k further elements follow them. Merges are
+ * thus never worse balanced than 2:1, and a list that fits in cache is
+ * sorted while it is still there, unlike the fully eager merges of a
+ * classic bottom-up sort.
+ *
+ * A sorted prefix of the list is found first and kept as a single run,
+ * so a list that is already sorted costs only n-1 comparisons and a
+ * nearly sorted one little more. The prev links are rebuilt during the
+ * final merge instead of in a separate pass.
  */
 void list_sort(void *priv, struct list_head *head,
 		int (*cmp)(void *priv, struct list_head *a,
 			struct list_head *b))
 {
-	struct list_head *part[MAX_LIST_LENGTH_BITS+1]; /* sorted partial lists
-						-- last slot is a sentinel */
-	int lev;  /* index into part[] */
-	int max_lev = 0;
-	struct list_head *list;
+	struct list_head *list = head->next, *run, *pending = NULL;
+	size_t count = 0;	/* Count of pending */
 
-	if (list_empty(head))
+	if (list == head->prev)	/* Zero or one elements */
 		return;
 
-	memset(part, 0, sizeof(part));
+	/* Find the presorted prefix */
+	run = list;
+	while (list->next != head && (*cmp)(priv, list, list->next) <= 0)
+		list = list->next;
+	if (list->next == head)
+		return;
 
+	/* Convert to a null-terminated singly-linked list. */
 	head->prev->next = NULL;
-	list = head->next;
 
-	while (list) {
-		struct list_head *cur = list;
+	if (list == run) {
+		/* Nothing presorted; sort the whole list */
+		run = NULL;
+		list = head->next;
+	} else {
+		struct list_head *tail = list;
+
 		list = list->next;
-		cur->next = NULL;
+		tail->next = NULL;
+	}
 
-		for (lev = 0; part[lev]; lev++) {
-			cur = merge(priv, cmp, part[lev], cur);
-			part[lev] = NULL;
-		}
-		if (lev > max_lev) {
-			if (unlikely(lev >= ARRAY_SIZE(part)-1)) {
-				printk_once(KERN_DEBUG "list passed to"
-					" list_sort() too long for"
-					" efficiency\n");
-				lev--;
-			}
-			max_lev = lev;
+	do {
+		size_t bits;
+		struct list_head **tail = &pending;
+
+		/* Find the least-significant clear bit in count */
+		for (bits = count; bits & 1; bits >>= 1)
+			tail = &(*tail)->prev;
+		/* Do the indicated merge */
+		if (likely(bits)) {
+			struct list_head *a = *tail, *b = a->prev;
+
+			a = merge(priv, cmp, b, a);
+			/* Install the merged result in place of the inputs */
+			a->prev = b->prev;
+			*tail = a;
 		}
-		part[lev] = cur;
-	}
 
-	for (lev = 0; lev < max_lev; lev++)
-		if (part[lev])
-			list = merge(priv, cmp, part[lev], list);
+		/* Move one element from the input list to pending */
+		list->prev = pending;
+		pending = list;
+		list = list->next;
+		pending->next = NULL;
+		count++;
+	} while (list);
+
+	/* End of input; merge together all the pending lists. */
+	list = pending;
+	pending = pending->prev;
+	while (pending) {
+		struct list_head *next = pending->prev;
+
+		if (!next && !run)
+			break;
+		list = merge(priv, cmp, pending, list);
+		pending = next;
+	}
 
-	merge_and_restore_back_links(priv, cmp, head, part[max_lev], list);
+	/* The final merge, rebuilding prev links */
+	merge_final(priv, cmp, head, run ? run : pending, list);
 }
 EXPORT_SYMBOL(list_sort);
 
 #ifdef CONFIG_TEST_LIST_SORT
 
 #include <linux/random.h>
+#include <linux/hrtimer.h>
 
 /*
  * The pattern of set bits in the list length determines which cases
@@ -165,6 +223,9 @@ struct debug_el {
 /* Array, containing pointers to all elements in the test list */
 static struct debug_el **elts __initdata;
 
+/* Number of cmp() calls, for the timing runs */
+static unsigned long cmp_count __initdata;
+
 static int __init check(struct debug_el *ela, struct debug_el *elb)
 {
 	if (ela->serial >= TEST_LIST_LEN) {
@@ -201,10 +262,26 @@ static int __init cmp(void *priv, struct list_head *a, struct list_head *b)
 	ela = container_of(a, struct debug_el, list);
 	elb = container_of(b, struct debug_el, list);
 
+	cmp_count++;
 	check(ela, elb);
 	return ela->value - elb->value;
 }
 
+/* Sort @head and report how long it took */
+static void __init list_sort_time(struct list_head *head, const char *what)
+{
+	ktime_t start;
+	s64 ns;
+
+	cmp_count = 0;
+	start = ktime_get();
+	list_sort(NULL, head, cmp);
+	ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	printk(KERN_DEBUG "list_sort_test: %d %s elements in %lld ns, "
+	       "%lu compares\n", TEST_LIST_LEN, what, ns, cmp_count);
+}
+
 static int __init list_sort_test(void)
 {
 	int i, count = 1, err = -EINVAL;
@@ -237,7 +314,7 @@ static int __init list_sort_test(void)
 		list_add_tail(&el->list, &head);
 	}
 
-	list_sort(NULL, &head, cmp);
+	list_sort_time(&head, "random");
 
 	for (cur = head.next; cur->next != &head; cur = cur->next) {
 		struct debug_el *el1;
@@ -278,6 +355,13 @@ static int __init list_sort_test(void)
 		goto exit;
 	}
 
+	/* Timing only: already sorted, then reversed input */
+	list_sort_time(&head, "sorted");
+
+	list_for_each_safe(cur, tmp, &head)
+		list_move(cur, &head);
+	list_sort_time(&head, "reversed");
+
 	err = 0;
 exit:
 	kfree(elts);
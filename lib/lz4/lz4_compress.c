@@ -34,11 +34,19 @@
  *  Chanho Min <chanho.min@lge.com>
  */
 
+#ifdef __KERNEL__
 #include <linux/module.h>
 #include <linux/kernel.h>
-#include <linux/lz4.h>
 #include <asm/unaligned.h>
+#endif
 #include "lz4defs.h"
+#include <linux/lz4.h>
+
+/*
+ * With 64-bit pointers the hash table holds 32-bit offsets from a base
+ * address, so a stream is rebased well before its offsets could wrap.
+ */
+#define LZ4_STREAM_REBASE	(1U << 30)
 
 /*
  * LZ4_compressCtx :
@@ -46,6 +54,8 @@
  * Compress 'isize' bytes from 'source' into an output buffer 'dest' of
  * maximum size 'maxOutputSize'.  * If it cannot achieve it, compression
  * will stop, and result of the function will be zero.
+ * Positions in 'ctx' are relative to 'tablebase', and matches may reach
+ * back to 'lowlimit' (at most 'source' for one-shot compression).
  * return : the number of bytes written in buffer 'dest', or 0 if the
  * compression fails
  */
@@ -53,12 +63,15 @@ static inline int lz4_compressctx(void *ctx,
 		const char *source,
 		char *dest,
 		int isize,
-		int maxoutputsize)
+		int maxoutputsize,
+		const u8 *tablebase,
+		const u8 *lowlimit,
+		int acceleration)
 {
 	HTYPE *hashtable = (HTYPE *)ctx;
 	const u8 *ip = (u8 *)source;
 #if LZ4_ARCH64
-	const BYTE * const base = ip;
+	const BYTE * const base = tablebase;
 #else
 	const int base = 0;
 #endif
@@ -78,8 +91,6 @@ static inline int lz4_compressctx(void *ctx,
 	if (isize < MINLENGTH)
 		goto _last_literals;
 
-	memset((void *)hashtable, 0, LZ4_MEM_COMPRESS);
-
 	/* First Byte */
 	hashtable[LZ4_HASH_VALUE(ip)] = ip - base;
 	ip++;
@@ -87,7 +98,7 @@ static inline int lz4_compressctx(void *ctx,
 
 	/* Main Loop */
 	for (;;) {
-		int findmatchattempts = (1U << skipstrength) + 3;
+		int findmatchattempts = (acceleration << skipstrength) + 3;
 		const u8 *forwardip = ip;
 		const u8 *ref;
 		u8 *token;
@@ -105,10 +116,11 @@ static inline int lz4_compressctx(void *ctx,
 			forwardh = LZ4_HASH_VALUE(forwardip);
 			ref = base + hashtable[h];
 			hashtable[h] = ip - base;
-		} while ((ref < ip - MAX_DISTANCE) || (A32(ref) != A32(ip)));
+		} while ((ref < lowlimit) || (ref < ip - MAX_DISTANCE) ||
+			(A32(ref) != A32(ip)));
 
 		/* Catch up */
-		while ((ip > anchor) && (ref > (u8 *)source) &&
+		while ((ip > anchor) && (ref > lowlimit) &&
 			unlikely(ip[-1] == ref[-1])) {
 			ip--;
 			ref--;
@@ -202,7 +214,8 @@ _endcount:
 		/* Test next position */
 		ref = base + hashtable[LZ4_HASH_VALUE(ip)];
 		hashtable[LZ4_HASH_VALUE(ip)] = ip - base;
-		if ((ref > ip - (MAX_DISTANCE + 1)) && (A32(ref) == A32(ip))) {
+		if ((ref >= lowlimit) && (ref > ip - (MAX_DISTANCE + 1)) &&
+			(A32(ref) == A32(ip))) {
 			token = op++;
 			*token = 0;
 			goto _next_match;
@@ -239,7 +252,8 @@ static inline int lz4_compress64kctx(void *ctx,
 		const char *source,
 		char *dest,
 		int isize,
-		int maxoutputsize)
+		int maxoutputsize,
+		int acceleration)
 {
 	u16 *hashtable = (u16 *)ctx;
 	const u8 *ip = (u8 *) source;
@@ -260,15 +274,13 @@ static inline int lz4_compress64kctx(void *ctx,
 	if (isize < MINLENGTH)
 		goto _last_literals;
 
-	memset((void *)hashtable, 0, LZ4_MEM_COMPRESS);
-
 	/* First Byte */
 	ip++;
 	forwardh = LZ4_HASH64K_VALUE(ip);
 
 	/* Main Loop */
 	for (;;) {
-		int findmatchattempts = (1U << skipstrength) + 3;
+		int findmatchattempts = (acceleration << skipstrength) + 3;
 		const u8 *forwardip = ip;
 		const u8 *ref;
 		u8 *token;
@@ -415,18 +427,32 @@ _last_literals:
 	return (int)(((char *)op) - dest);
 }
 
-int lz4_compress(const unsigned char *src, size_t src_len,
-			unsigned char *dst, size_t *dst_len, void *wrkmem)
+static inline int lz4_clamp_acceleration(int acceleration)
+{
+	if (acceleration < LZ4_ACCELERATION_DEFAULT)
+		return LZ4_ACCELERATION_DEFAULT;
+	if (acceleration > LZ4_ACCELERATION_MAX)
+		return LZ4_ACCELERATION_MAX;
+	return acceleration;
+}
+
+int lz4_compress_fast(const unsigned char *src, size_t src_len,
+		unsigned char *dst, size_t *dst_len, void *wrkmem,
+		int acceleration)
 {
 	int ret = -1;
 	int out_len = 0;
 
+	acceleration = lz4_clamp_acceleration(acceleration);
+	memset(wrkmem, 0, LZ4_MEM_COMPRESS);
+
 	if (src_len < LZ4_64KLIMIT)
 		out_len = lz4_compress64kctx(wrkmem, src, dst, src_len,
-				lz4_compressbound(src_len));
+				lz4_compressbound(src_len), acceleration);
 	else
 		out_len = lz4_compressctx(wrkmem, src, dst, src_len,
-				lz4_compressbound(src_len));
+				lz4_compressbound(src_len),
+				src, src, acceleration);
 
 	if (out_len < 0)
 		goto exit;
@@ -437,7 +463,90 @@ int lz4_compress(const unsigned char *src, size_t src_len,
 exit:
 	return ret;
 }
+EXPORT_SYMBOL(lz4_compress_fast);
+
+int lz4_compress(const unsigned char *src, size_t src_len,
+			unsigned char *dst, size_t *dst_len, void *wrkmem)
+{
+	return lz4_compress_fast(src, src_len, dst, dst_len, wrkmem,
+				LZ4_ACCELERATION_DEFAULT);
+}
 EXPORT_SYMBOL(lz4_compress);
 
+void lz4_stream_reset(struct lz4_stream *stream)
+{
+	memset(stream, 0, sizeof(*stream));
+}
+EXPORT_SYMBOL(lz4_stream_reset);
+
+int lz4_loaddict(struct lz4_stream *stream, const unsigned char *dict,
+		size_t dict_size)
+{
+	HTYPE *hashtable = (HTYPE *)stream->hashtable;
+	const u8 *p, *dictend = dict + dict_size;
+#if LZ4_ARCH64
+	const BYTE *base;
+#else
+	const int base = 0;
+#endif
+
+	lz4_stream_reset(stream);
+
+	if (dict_size > MAXD)
+		dict = dictend - MAXD;
+	stream->base = dict;
+	stream->dict = dict;
+	stream->dict_size = dictend - dict;
+	if (stream->dict_size < MINMATCH)
+		return stream->dict_size;
+
+#if LZ4_ARCH64
+	base = stream->base;
+#endif
+	for (p = dict; p <= dictend - MINMATCH; p += 3)
+		hashtable[LZ4_HASH_VALUE(p)] = p - base;
+
+	return stream->dict_size;
+}
+EXPORT_SYMBOL(lz4_loaddict);
+
+int lz4_compress_continue(struct lz4_stream *stream,
+		const unsigned char *src, size_t src_len,
+		unsigned char *dst, size_t *dst_len, int acceleration)
+{
+	const u8 *dictend = stream->dict + stream->dict_size;
+	const u8 *srcend = src + src_len;
+	int out_len;
+
+	acceleration = lz4_clamp_acceleration(acceleration);
+
+	if (!stream->dict_size || src != dictend) {
+		/* Not contiguous with the history: start over from 'src' */
+		lz4_stream_reset(stream);
+		stream->base = src;
+		stream->dict = src;
+#if LZ4_ARCH64
+	} else if ((size_t)(srcend - stream->base) > LZ4_STREAM_REBASE) {
+		/* Keep the last 64KB of history, relative to a new base */
+		lz4_loaddict(stream, stream->dict, stream->dict_size);
+#endif
+	}
+
+	out_len = lz4_compressctx(stream->hashtable, src, dst, src_len,
+			lz4_compressbound(src_len), stream->base,
+			stream->dict, acceleration);
+	if (out_len <= 0)
+		return -1;
+
+	/* History now ends with 'src', and never reaches back beyond 64KB */
+	if (srcend - stream->dict > MAXD)
+		stream->dict = srcend - MAXD;
+	stream->dict_size = srcend - stream->dict;
+
+	*dst_len = out_len;
+	return 0;
+}
+EXPORT_SYMBOL(lz4_compress_continue);
+
 MODULE_LICENSE("Dual BSD/GPL");
 MODULE_DESCRIPTION("LZ4 compressor");
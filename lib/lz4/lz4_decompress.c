@@ -37,15 +37,16 @@
  *  - LZ4 source repository : http://code.google.com/p/lz4/
  */
 
-#ifndef STATIC
+#if !defined(STATIC) && defined(__KERNEL__)
 #include <linux/module.h>
 #include <linux/kernel.h>
 #endif
-#include <linux/lz4.h>
-
+#ifdef __KERNEL__
 #include <asm/unaligned.h>
+#endif
 
 #include "lz4defs.h"
+#include <linux/lz4.h>
 
 static int lz4_uncompress(const char *source, char *dest, int osize)
 {
@@ -166,10 +167,12 @@ _output_error:
 }
 
 static int lz4_uncompress_unknownoutputsize(const char *source, char *dest,
-				int isize, size_t maxoutputsize)
+				int isize, size_t maxoutputsize,
+				size_t prefix_size)
 {
 	const BYTE *ip = (const BYTE *) source;
 	const BYTE *const iend = ip + isize;
+	const BYTE *const lowlimit = (const BYTE *) dest - prefix_size;
 	const BYTE *ref;
 
 
@@ -225,11 +228,11 @@ static int lz4_uncompress_unknownoutputsize(const char *source, char *dest,
 		/* get offset */
 		LZ4_READ_LITTLEENDIAN_16(ref, cpy, ip);
 		ip += 2;
-		if (ref < (BYTE * const) dest)
+		if (ref < lowlimit)
 			goto _output_error;
 			/*
 			 * Error : offset creates reference
-			 * outside of destination buffer
+			 * outside of destination buffer and prefix
 			 */
 
 		/* get matchlength */
@@ -320,7 +323,7 @@ int lz4_decompress_unknownoutputsize(const unsigned char *src, size_t src_len,
 	int out_len = 0;
 
 	out_len = lz4_uncompress_unknownoutputsize(src, dest, src_len,
-					*dest_len);
+					*dest_len, 0);
 	if (out_len < 0)
 		goto exit_0;
 	*dest_len = out_len;
@@ -331,6 +334,26 @@ exit_0:
 }
 #ifndef STATIC
 EXPORT_SYMBOL(lz4_decompress_unknownoutputsize);
+#endif
+
+int lz4_decompress_continue(const unsigned char *src, size_t src_len,
+		unsigned char *dest, size_t *dest_len, size_t prefix_size)
+{
+	int out_len;
+
+	if (prefix_size > MAXD)
+		prefix_size = MAXD;
+
+	out_len = lz4_uncompress_unknownoutputsize(src, dest, src_len,
+					*dest_len, prefix_size);
+	if (out_len < 0)
+		return -1;
+	*dest_len = out_len;
+
+	return 0;
+}
+#ifndef STATIC
+EXPORT_SYMBOL(lz4_decompress_continue);
 
 MODULE_LICENSE("Dual BSD/GPL");
 MODULE_DESCRIPTION("LZ4 Decompressor");
@@ -8,6 +8,40 @@
  * published by the Free Software Foundation.
  */
 
+#ifndef __KERNEL__
+/* Used for testing in user space */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef uint8_t  u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+#define likely(x)	__builtin_expect(!!(x), 1)
+#define unlikely(x)	__builtin_expect(!!(x), 0)
+
+#define get_unaligned(p)					\
+	({							\
+		const struct { __typeof__(*(p)) v; }		\
+			__attribute__((packed)) *__pp = (const void *)(p); \
+		__pp->v;					\
+	})
+#define put_unaligned(val, p)					\
+	do {							\
+		struct { __typeof__(*(p)) v; }			\
+			__attribute__((packed)) *__pp = (void *)(p); \
+		__pp->v = (val);				\
+	} while (0)
+#define get_unaligned_le16(p)				\
+	((u16)(((const u8 *)(p))[0] | ((const u8 *)(p))[1] << 8))
+
+#define EXPORT_SYMBOL(sym)
+#define MODULE_LICENSE(license)
+#define MODULE_DESCRIPTION(desc)
+#endif /* __KERNEL__ */
+
 /*
  * Detects 64 bits mode
  */
@@ -0,0 +1,236 @@
+/*
+ * lz4test.c
+ *
+ * Check and benchmark the kernel LZ4 code from userspace, on page-sized
+ * and multi-page blocks, for a range of acceleration factors and for
+ * streaming compression across consecutive pages.
+ *
+ * Usage: lz4test [file]
+ * Without a file, a repeatable text-like corpus is generated.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <linux/lz4.h>
+
+#define PAGE_SIZE	4096
+#define CORPUS_SIZE	(4 << 20)
+#define MIN_BENCH_NS	200000000ULL	/* Repeat each run for 0.2s */
+
+static unsigned char *corpus, *cbuf, *dbuf;
+static size_t corpus_size;
+static size_t *clens;
+static unsigned long lz4_wrkmem[LZ4_MEM_COMPRESS / sizeof(unsigned long)];
+static struct lz4_stream stream;
+
+static const int block_sizes[] = { PAGE_SIZE, 4 * PAGE_SIZE, 16 * PAGE_SIZE };
+static const int accelerations[] = { 1, 2, 4, 8, 16 };
+
+#define ARRAY_SIZE(a)	(sizeof(a) / sizeof((a)[0]))
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Words with a skewed distribution and some noise, roughly 2:1 with LZ4 */
+static void make_corpus(void)
+{
+	static const char * const words[] = {
+		"the", "page", "inode", "block", "kernel", "struct", "return",
+		"mapping", "buffer", "lock", "dirty", "write", "read", "zone",
+		"0x", "NULL", "if", "for", "int", "unsigned", "long", "=",
+		"->", ";", "{", "}", "\n", "\t",
+	};
+	unsigned int seed = 1;
+	size_t pos = 0;
+
+	corpus_size = CORPUS_SIZE;
+	corpus = malloc(corpus_size);
+	if (!corpus)
+		exit(1);
+
+	while (pos < corpus_size) {
+		const char *w;
+		char num[16];
+		size_t len;
+
+		seed = seed * 1103515245 + 12345;
+		if ((seed >> 16) % 8 == 0) {
+			snprintf(num, sizeof(num), "%u ", (seed >> 8) & 0xffff);
+			w = num;
+		} else {
+			unsigned int r = (seed >> 16) % ARRAY_SIZE(words);
+
+			/* Favour the head of the vocabulary */
+			w = words[(r * r) / ARRAY_SIZE(words)];
+		}
+		len = strlen(w);
+		if (len > corpus_size - pos)
+			len = corpus_size - pos;
+		memcpy(corpus + pos, w, len);
+		pos += len;
+		if (pos < corpus_size && w != num)
+			corpus[pos++] = ' ';
+	}
+}
+
+static void load_corpus(const char *name)
+{
+	FILE *f = fopen(name, "rb");
+	long size;
+
+	if (!f || fseek(f, 0, SEEK_END) || (size = ftell(f)) <= 0) {
+		perror(name);
+		exit(1);
+	}
+	rewind(f);
+	corpus_size = size;
+	corpus = malloc(corpus_size);
+	if (!corpus || fread(corpus, 1, corpus_size, f) != corpus_size) {
+		perror(name);
+		exit(1);
+	}
+	fclose(f);
+}
+
+/* Compress every block, return the total compressed size */
+static size_t compress_blocks(int bsize, int acceleration, int streaming)
+{
+	size_t nblocks = corpus_size / bsize;
+	size_t i, total = 0;
+
+	lz4_stream_reset(&stream);
+	for (i = 0; i < nblocks; i++) {
+		unsigned char *dst = cbuf + i * lz4_compressbound(bsize);
+		int err;
+
+		if (streaming)
+			err = lz4_compress_continue(&stream,
+					corpus + i * bsize, bsize,
+					dst, &clens[i], acceleration);
+		else
+			err = lz4_compress_fast(corpus + i * bsize, bsize,
+					dst, &clens[i], lz4_wrkmem,
+					acceleration);
+		if (err < 0) {
+			fprintf(stderr, "compression failed at block %zu\n", i);
+			exit(1);
+		}
+		total += clens[i];
+	}
+	return total;
+}
+
+static void decompress_blocks(int bsize, int streaming)
+{
+	size_t nblocks = corpus_size / bsize;
+	size_t i;
+
+	for (i = 0; i < nblocks; i++) {
+		size_t dlen = bsize;
+		size_t prefix = streaming ? i * bsize : 0;
+		int err;
+
+		err = lz4_decompress_continue(cbuf + i * lz4_compressbound(bsize),
+				clens[i], dbuf + i * bsize, &dlen, prefix);
+		if (err < 0 || dlen != (size_t)bsize) {
+			fprintf(stderr, "decompression failed at block %zu\n",
+				i);
+			exit(1);
+		}
+	}
+}
+
+static double mbps(size_t bytes, unsigned long long ns)
+{
+	return (double)bytes * 1000 / ns;
+}
+
+static int run(int bsize, int acceleration, int streaming)
+{
+	size_t bytes = corpus_size / bsize * bsize;
+	unsigned long long start, cns, dns;
+	size_t csize = 0;
+	int rounds;
+
+	rounds = 0;
+	start = now_ns();
+	do {
+		csize = compress_blocks(bsize, acceleration, streaming);
+		rounds++;
+	} while ((cns = now_ns() - start) < MIN_BENCH_NS);
+	cns /= rounds;
+
+	memset(dbuf, 0, corpus_size);
+	rounds = 0;
+	start = now_ns();
+	do {
+		decompress_blocks(bsize, streaming);
+		rounds++;
+	} while ((dns = now_ns() - start) < MIN_BENCH_NS);
+	dns /= rounds;
+
+	if (memcmp(corpus, dbuf, bytes)) {
+		printf("block=%-6d accel=%-3d %-7s  ERROR: data mismatch\n",
+		       bsize, acceleration, streaming ? "stream" : "oneshot");
+		return 1;
+	}
+
+	printf("block=%-6d accel=%-3d %-7s  ratio=%5.3f  "
+	       "compress=%8.1f MB/s  decompress=%8.1f MB/s\n",
+	       bsize, acceleration, streaming ? "stream" : "oneshot",
+	       (double)bytes / csize, mbps(bytes, cns), mbps(bytes, dns));
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	size_t nblocks = 0;
+	unsigned int i, j;
+	int err = 0;
+
+	if (argc > 1)
+		load_corpus(argv[1]);
+	else
+		make_corpus();
+
+	if (corpus_size < PAGE_SIZE) {
+		fprintf(stderr, "corpus smaller than a page\n");
+		return 1;
+	}
+
+	nblocks = corpus_size / PAGE_SIZE;
+	cbuf = malloc(nblocks * lz4_compressbound(PAGE_SIZE));
+	dbuf = malloc(corpus_size);
+	clens = calloc(nblocks, sizeof(*clens));
+	if (!cbuf || !dbuf || !clens)
+		return 1;
+
+	printf("corpus: %zu bytes\n", corpus_size);
+
+	for (i = 0; i < ARRAY_SIZE(block_sizes); i++)
+		for (j = 0; j < ARRAY_SIZE(accelerations); j++)
+			err += run(block_sizes[i], accelerations[j], 0);
+
+	for (j = 0; j < ARRAY_SIZE(accelerations); j++)
+		err += run(PAGE_SIZE, accelerations[j], 1);
+
+	printf("\n");
+	if (!err)
+		printf("All tests passed\n");
+	else
+		printf("%d tests failed\n", err);
+
+	return err != 0;
+}
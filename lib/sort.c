@@ -1,19 +1,43 @@
 /*
- * A fast, small, non-recursive O(nlog n) sort for the Linux kernel
+ * A fast, small O(nlog n) sort for the Linux kernel
  *
  * Jan 23 2005  Matt Mackall <mpm@selenic.com>
+ *
+ * Introsort, sort_r() and word sized swaps.
  */
 
 #include <linux/kernel.h>
 #include <linux/module.h>
 #include <linux/sort.h>
 #include <linux/slab.h>
+#include <linux/log2.h>
 
+/*
+ * Swapping is the bulk of the work for the common element sizes, so
+ * the swaps for elements made of aligned 32 or 64 bit words are called
+ * directly by do_swap() rather than through a pointer, and move a word
+ * at a time rather than a byte.
+ */
 static void u32_swap(void *a, void *b, int size)
 {
-	u32 t = *(u32 *)a;
-	*(u32 *)a = *(u32 *)b;
-	*(u32 *)b = t;
+	u32 *x = a, *y = b, t;
+
+	do {
+		t = *x;
+		*x++ = *y;
+		*y++ = t;
+	} while ((size -= 4) > 0);
+}
+
+static void u64_swap(void *a, void *b, int size)
+{
+	u64 *x = a, *y = b, t;
+
+	do {
+		t = *x;
+		*x++ = *y;
+		*y++ = t;
+	} while ((size -= 8) > 0);
 }
 
 static void generic_swap(void *a, void *b, int size)
@@ -27,97 +51,388 @@ static void generic_swap(void *a, void *b, int size)
 	} while (--size > 0);
 }
 
-/**
- * sort - sort an array of elements
- * @base: pointer to data to sort
- * @num: number of elements
- * @size: size of each element
- * @cmp_func: pointer to comparison function
- * @swap_func: pointer to swap function or NULL
- *
- * This function does a heapsort on the given array. You may provide a
- * swap_func function optimized to your element type.
- *
- * Sorting time is O(n log n) both on average and worst-case. While
- * qsort is about 20% faster on average, it suffers from exploitable
- * O(n*n) worst-case behavior and extra memory requirements that make
- * it less suitable for kernel use.
+/* Can elements of @size at @base be swapped @align bytes at a time? */
+static inline int swap_aligned(const void *base, size_t size, size_t align)
+{
+	return ((unsigned long)base | size) % align == 0;
+}
+
+static inline void do_swap(void *a, void *b, int size,
+			   void (*swap_func)(void *, void *, int))
+{
+	if (swap_func == u64_swap)
+		u64_swap(a, b, size);
+	else if (swap_func == u32_swap)
+		u32_swap(a, b, size);
+	else if (swap_func == generic_swap)
+		generic_swap(a, b, size);
+	else
+		swap_func(a, b, size);
+}
+
+/*
+ * sort() is sort_r() with the plain comparison function passed as the
+ * private data, and this as the comparison function.
  */
+#define SORT_CMP_WRAPPER ((int (*)(const void *, const void *, \
+				   const void *))NULL)
 
-void sort(void *base, size_t num, size_t size,
-	  int (*cmp_func)(const void *, const void *),
-	  void (*swap_func)(void *, void *, int size))
+static inline int do_cmp(const void *a, const void *b,
+			 int (*cmp_func)(const void *, const void *,
+					 const void *),
+			 const void *priv)
 {
-	/* pre-scale counters for performance */
-	int i = (num/2 - 1) * size, n = num * size, c, r;
+	if (cmp_func == SORT_CMP_WRAPPER)
+		return ((int (*)(const void *, const void *))priv)(a, b);
+	return cmp_func(a, b, priv);
+}
+
+struct sort_ctx {
+	size_t size;
+	int (*cmp_func)(const void *, const void *, const void *);
+	void (*swap_func)(void *, void *, int);
+	const void *priv;
+};
 
-	if (!swap_func)
-		swap_func = (size == 4 ? u32_swap : generic_swap);
+#define CMP(c, a, b)	do_cmp(a, b, (c)->cmp_func, (c)->priv)
+#define SWAP(c, a, b)	do_swap(a, b, (c)->size, (c)->swap_func)
+
+/* Runs this short are finished off by insertion sort */
+#define SORT_INSERTION_THRESHOLD	16
+
+static void insertion_sort(char *base, size_t num, const struct sort_ctx *c)
+{
+	size_t size = c->size;
+	char *end = base + num * size, *i, *j;
+
+	for (i = base + size; i < end; i += size)
+		for (j = i; j > base && CMP(c, j - size, j) > 0; j -= size)
+			SWAP(c, j - size, j);
+}
+
+static void heapsort(char *base, size_t num, const struct sort_ctx *c)
+{
+	/* pre-scale counters for performance */
+	int size = c->size;
+	int i = (num/2 - 1) * size, n = num * size, m, r;
 
 	/* heapify */
 	for ( ; i >= 0; i -= size) {
-		for (r = i; r * 2 + size < n; r  = c) {
-			c = r * 2 + size;
-			if (c < n - size &&
-					cmp_func(base + c, base + c + size) < 0)
-				c += size;
-			if (cmp_func(base + r, base + c) >= 0)
+		for (r = i; r * 2 + size < n; r  = m) {
+			m = r * 2 + size;
+			if (m < n - size &&
+					CMP(c, base + m, base + m + size) < 0)
+				m += size;
+			if (CMP(c, base + r, base + m) >= 0)
 				break;
-			swap_func(base + r, base + c, size);
+			SWAP(c, base + r, base + m);
 		}
 	}
 
 	/* sort */
 	for (i = n - size; i > 0; i -= size) {
-		swap_func(base, base + i, size);
-		for (r = 0; r * 2 + size < i; r = c) {
-			c = r * 2 + size;
-			if (c < i - size &&
-					cmp_func(base + c, base + c + size) < 0)
-				c += size;
-			if (cmp_func(base + r, base + c) >= 0)
+		SWAP(c, base, base + i);
+		for (r = 0; r * 2 + size < i; r = m) {
+			m = r * 2 + size;
+			if (m < i - size &&
+					CMP(c, base + m, base + m + size) < 0)
+				m += size;
+			if (CMP(c, base + r, base + m) >= 0)
 				break;
-			swap_func(base + r, base + c, size);
+			SWAP(c, base + r, base + m);
+		}
+	}
+}
+
+/*
+ * Partition base[0..num-1] around the median of the elements at a quarter,
+ * half and three quarters of it, and return the final index of that
+ * pivot. The first and last elements are poor samples of sorted, reversed
+ * and organ pipe input, so they are swapped with the quartiles first. The
+ * smallest and largest of the three then stay at the ends, where they stop
+ * both scans, and the pivot waits next to the first until the scans meet.
+ * Both scans stop on elements equal to the pivot, so runs of equal keys
+ * split evenly instead of degrading to quadratic behaviour.
+ */
+static size_t partition(char *base, size_t num, const struct sort_ctx *c)
+{
+	size_t size = c->size;
+	char *pivot = base + size;
+	char *mid = base + (num / 2) * size;
+	char *last = base + (num - 1) * size;
+	char *i, *j;
+
+	SWAP(c, base, base + (num / 4) * size);
+	SWAP(c, last, last - (num / 4) * size);
+	if (CMP(c, mid, base) < 0)
+		SWAP(c, mid, base);
+	if (CMP(c, last, mid) < 0) {
+		SWAP(c, last, mid);
+		if (CMP(c, mid, base) < 0)
+			SWAP(c, mid, base);
+	}
+	SWAP(c, pivot, mid);
+
+	/* partition base[2..num-2]: *base <= pivot <= *last */
+	i = pivot;
+	j = last;
+	for (;;) {
+		do
+			i += size;
+		while (CMP(c, i, pivot) < 0);
+		do
+			j -= size;
+		while (CMP(c, pivot, j) < 0);
+		if (i >= j)
+			break;
+		SWAP(c, i, j);
+	}
+	SWAP(c, pivot, j);
+
+	return (j - base) / size;
+}
+
+/*
+ * Quicksort the smaller side of each partition recursively and loop on
+ * the larger one, so the stack depth stays below log2(num). A range
+ * that is still being partitioned after 2*log2(num) levels is handed to
+ * heapsort, which keeps the worst case at O(n log n).
+ */
+static void introsort(char *base, size_t num, int depth,
+		      const struct sort_ctx *c)
+{
+	size_t p;
+
+	while (num > SORT_INSERTION_THRESHOLD) {
+		if (!depth--) {
+			heapsort(base, num, c);
+			return;
+		}
+
+		p = partition(base, num, c);
+		if (p < num - p - 1) {
+			introsort(base, p, depth, c);
+			base += (p + 1) * c->size;
+			num -= p + 1;
+		} else {
+			introsort(base + (p + 1) * c->size, num - p - 1,
+				  depth, c);
+			num = p;
 		}
 	}
+
+	insertion_sort(base, num, c);
+}
+
+/**
+ * sort_r - sort an array of elements
+ * @base: pointer to data to sort
+ * @num: number of elements
+ * @size: size of each element
+ * @cmp_func: pointer to comparison function
+ * @swap_func: pointer to swap function or NULL
+ * @priv: third argument passed to @cmp_func
+ *
+ * This function does an introsort on the given array: a quicksort
+ * that falls back to heapsort when it picks too many bad pivots, and
+ * to insertion sort for short runs. You may provide a swap_func
+ * function optimized to your element type; without one, elements made
+ * of aligned 32 or 64 bit words are swapped a word at a time.
+ *
+ * Sorting time is O(n log n) both on average and worst-case, and the
+ * sort needs O(log n) stack. The sort is not stable.
+ */
+void sort_r(void *base, size_t num, size_t size,
+	    int (*cmp_func)(const void *, const void *, const void *),
+	    void (*swap_func)(void *, void *, int),
+	    const void *priv)
+{
+	struct sort_ctx c = {
+		.size		= size,
+		.cmp_func	= cmp_func,
+		.swap_func	= swap_func,
+		.priv		= priv,
+	};
+
+	if (num < 2 || !size)
+		return;
+
+	if (!c.swap_func) {
+		if (swap_aligned(base, size, 8))
+			c.swap_func = u64_swap;
+		else if (swap_aligned(base, size, 4))
+			c.swap_func = u32_swap;
+		else
+			c.swap_func = generic_swap;
+	}
+
+	introsort(base, num, 2 * ilog2(num), &c);
+}
+EXPORT_SYMBOL(sort_r);
+
+/**
+ * sort - sort an array of elements
+ * @base: pointer to data to sort
+ * @num: number of elements
+ * @size: size of each element
+ * @cmp_func: pointer to comparison function
+ * @swap_func: pointer to swap function or NULL
+ *
+ * As sort_r(), for comparison functions that need no private data.
+ */
+void sort(void *base, size_t num, size_t size,
+	  int (*cmp_func)(const void *, const void *),
+	  void (*swap_func)(void *, void *, int size))
+{
+	sort_r(base, num, size, SORT_CMP_WRAPPER, swap_func,
+	       (const void *)cmp_func);
 }
 
 EXPORT_SYMBOL(sort);
 
-#if 0
-/* a simple boot-time regression test */
+#ifdef CONFIG_TEST_SORT
+
+#include <linux/random.h>
+#include <linux/hrtimer.h>
+
+/* a simple boot-time regression test and benchmark */
+
+#define TEST_SORT_LEN	4096
 
-int cmpint(const void *a, const void *b)
+/*
+ * Heapsort alone takes about 1.8 n log2(n) compares on every input, the
+ * introsort about n log2(n). Sorted, reversed and organ pipe input must
+ * not cost more than half again as much.
+ */
+#define TEST_SORT_MAX_CMPS	(TEST_SORT_LEN * ilog2(TEST_SORT_LEN) * 3 / 2)
+
+struct sort_test_el {
+	u32 key;
+	u32 serial;
+	u64 pad;
+};
+
+static int __init cmp_u32(const void *a, const void *b)
 {
-	return *(int *)a - *(int *)b;
+	u32 x = *(const u32 *)a, y = *(const u32 *)b;
+
+	return x < y ? -1 : x > y;
 }
 
-static int sort_test(void)
+static int __init cmp_el_r(const void *a, const void *b, const void *priv)
 {
-	int *a, i, r = 1;
+	const struct sort_test_el *x = a, *y = b;
+	int *calls = (int *)priv;
 
-	a = kmalloc(1000 * sizeof(int), GFP_KERNEL);
-	BUG_ON(!a);
+	(*calls)++;
+	return cmp_u32(&x->key, &y->key);
+}
 
-	printk("testing sort()\n");
+static void __init fill(u32 *a, size_t num, int pattern)
+{
+	size_t i;
 
-	for (i = 0; i < 1000; i++) {
-		r = (r * 725861) % 6599;
-		a[i] = r;
+	for (i = 0; i < num; i++) {
+		switch (pattern) {
+		case 0:		/* random */
+			a[i] = random32();
+			break;
+		case 1:		/* sorted */
+			a[i] = i;
+			break;
+		case 2:		/* reversed */
+			a[i] = num - i;
+			break;
+		case 3:		/* few distinct keys */
+			a[i] = random32() % 8;
+			break;
+		case 4:		/* organ pipe */
+			a[i] = i < num / 2 ? i : num - i;
+			break;
+		}
 	}
+}
 
-	sort(a, 1000, sizeof(int), cmpint, NULL);
+static const char * const sort_test_pattern[] __initconst = {
+	"random", "sorted", "reversed", "few keys", "organ pipe",
+};
 
-	for (i = 0; i < 999; i++)
-		if (a[i] > a[i+1]) {
-			printk("sort() failed!\n");
-			break;
+static int __init sort_test(void)
+{
+	struct sort_test_el *el;
+	u32 *a;
+	int i, p, calls, err = -ENOMEM;
+	ktime_t start;
+	s64 ns;
+
+	printk(KERN_DEBUG "sort_test: start testing sort()\n");
+
+	a = kmalloc(TEST_SORT_LEN * sizeof(*a), GFP_KERNEL);
+	el = kmalloc(TEST_SORT_LEN * sizeof(*el), GFP_KERNEL);
+	if (!a || !el) {
+		printk(KERN_ERR "sort_test: error: cannot allocate memory\n");
+		goto exit;
+	}
+
+	err = -EINVAL;
+	for (p = 0; p < ARRAY_SIZE(sort_test_pattern); p++) {
+		fill(a, TEST_SORT_LEN, p);
+		start = ktime_get();
+		sort(a, TEST_SORT_LEN, sizeof(*a), cmp_u32, NULL);
+		ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+		for (i = 0; i < TEST_SORT_LEN - 1; i++)
+			if (a[i] > a[i+1]) {
+				printk(KERN_ERR "sort_test: error: %s u32 "
+				       "array not sorted\n",
+				       sort_test_pattern[p]);
+				goto exit;
+			}
+
+		printk(KERN_DEBUG "sort_test: %d %s u32 in %lld ns\n",
+		       TEST_SORT_LEN, sort_test_pattern[p], ns);
+	}
+
+	for (p = 0; p < ARRAY_SIZE(sort_test_pattern); p++) {
+		fill(a, TEST_SORT_LEN, p);
+		for (i = 0; i < TEST_SORT_LEN; i++) {
+			el[i].key = a[i];
+			el[i].serial = i;
+			el[i].pad = 0;
 		}
 
-	kfree(a);
+		calls = 0;
+		start = ktime_get();
+		sort_r(el, TEST_SORT_LEN, sizeof(*el), cmp_el_r, NULL, &calls);
+		ns = ktime_to_ns(ktime_sub(ktime_get(), start));
 
-	return 0;
-}
+		for (i = 0; i < TEST_SORT_LEN - 1; i++)
+			if (el[i].key > el[i+1].key) {
+				printk(KERN_ERR "sort_test: error: %s "
+				       "sort_r() array not sorted\n",
+				       sort_test_pattern[p]);
+				goto exit;
+			}
+
+		printk(KERN_DEBUG "sort_test: %d %s 16 byte elements in "
+		       "%lld ns, %d compares\n", TEST_SORT_LEN,
+		       sort_test_pattern[p], ns, calls);
+
+		if ((p == 1 || p == 2 || p == 4) &&
+		    calls > TEST_SORT_MAX_CMPS) {
+			printk(KERN_ERR "sort_test: error: %s took %d "
+			       "compares, more than %d\n",
+			       sort_test_pattern[p], calls,
+			       TEST_SORT_MAX_CMPS);
+			goto exit;
+		}
+	}
 
+	err = 0;
+exit:
+	kfree(el);
+	kfree(a);
+	return err;
+}
 module_init(sort_test);
-#endif
+#endif /* CONFIG_TEST_SORT */
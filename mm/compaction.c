@@ -14,6 +14,8 @@
 #include <linux/backing-dev.h>
 #include <linux/sysctl.h>
 #include <linux/sysfs.h>
+#include <linux/kthread.h>
+#include <linux/freezer.h>
 #include "internal.h"
 
 #define CREATE_TRACE_POINTS
@@ -758,6 +760,200 @@ int sysctl_extfrag_handler(struct ctl_table *table, int write,
 	return 0;
 }
 
+/*
+ * kcompactd compacts in the background, so that high-order allocations
+ * find a free block instead of compacting directly.  kswapd wakes it on
+ * its way to sleep when the fragmentation index of a zone for
+ * kcompactd_order is above kcompactd_extfrag_threshold, i.e. when an
+ * allocation of that order would fail for fragmentation rather than for
+ * lack of memory.  Runs that leave the zones as fragmented as they were
+ * hold off further wakeups for twice as long each time.
+ */
+int sysctl_kcompactd_order = PAGE_ALLOC_COSTLY_ORDER;
+int sysctl_kcompactd_extfrag_threshold = 500;
+
+/* kcompactd is not woken again for this long << backoff after a failure */
+#define KCOMPACTD_BACKOFF_JIFFIES	(HZ/2)
+
+static bool kcompactd_zone_suitable(struct zone *zone, int order)
+{
+	if (!populated_zone(zone))
+		return false;
+
+	if (fragmentation_index(zone, order) <=
+	    sysctl_kcompactd_extfrag_threshold)
+		return false;
+
+	return compaction_suitable(zone, order) == COMPACT_CONTINUE;
+}
+
+static bool kcompactd_node_suitable(pg_data_t *pgdat, int order)
+{
+	int zoneid;
+
+	for (zoneid = 0; zoneid < pgdat->nr_zones; zoneid++)
+		if (kcompactd_zone_suitable(&pgdat->node_zones[zoneid], order))
+			return true;
+
+	return false;
+}
+
+static void kcompactd_do_work(pg_data_t *pgdat)
+{
+	int order = sysctl_kcompactd_order;
+	unsigned long start = jiffies;
+	int nr_success = 0, nr_fail = 0;
+	int zoneid;
+
+	count_vm_event(KCOMPACTD_WAKE);
+
+	for (zoneid = 0; zoneid < pgdat->nr_zones; zoneid++) {
+		struct zone *zone = &pgdat->node_zones[zoneid];
+		struct compact_control cc = {
+			.nr_freepages = 0,
+			.nr_migratepages = 0,
+			.order = order,
+			.migratetype = MIGRATE_MOVABLE,
+			.zone = zone,
+			.sync = false,
+		};
+
+		if (!order || !kcompactd_zone_suitable(zone, order))
+			continue;
+
+		INIT_LIST_HEAD(&cc.freepages);
+		INIT_LIST_HEAD(&cc.migratepages);
+
+		compact_zone(zone, &cc);
+
+		VM_BUG_ON(!list_empty(&cc.freepages));
+		VM_BUG_ON(!list_empty(&cc.migratepages));
+
+		if (fragmentation_index(zone, order) <=
+		    sysctl_kcompactd_extfrag_threshold)
+			nr_success++;
+		else
+			nr_fail++;
+
+		if (kthread_should_stop())
+			break;
+	}
+
+	count_vm_events(KCOMPACTD_SUCCESS, nr_success);
+	count_vm_events(KCOMPACTD_FAIL, nr_fail);
+	count_vm_events(KCOMPACTD_TIME, jiffies_to_msecs(jiffies - start));
+
+	if (nr_success) {
+		pgdat->kcompactd_backoff = 0;
+		pgdat->kcompactd_next = jiffies;
+	} else if (nr_fail) {
+		if (pgdat->kcompactd_backoff < COMPACT_MAX_DEFER_SHIFT)
+			pgdat->kcompactd_backoff++;
+		pgdat->kcompactd_next = jiffies +
+			(KCOMPACTD_BACKOFF_JIFFIES << pgdat->kcompactd_backoff);
+	}
+}
+
+/**
+ * wakeup_kcompactd - have kcompactd compact a fragmented node
+ * @pgdat: the node
+ *
+ * Called by kswapd before it sleeps, once it has brought the free pages
+ * of @pgdat back above the high watermark.
+ */
+void wakeup_kcompactd(pg_data_t *pgdat)
+{
+	if (!sysctl_kcompactd_order || !pgdat->kcompactd)
+		return;
+
+	if (time_before(jiffies, pgdat->kcompactd_next))
+		return;
+
+	/* Still busy with the last request */
+	if (!waitqueue_active(&pgdat->kcompactd_wait))
+		return;
+
+	if (!kcompactd_node_suitable(pgdat, sysctl_kcompactd_order))
+		return;
+
+	pgdat->kcompactd_wake = true;
+	wake_up_interruptible(&pgdat->kcompactd_wait);
+}
+
+static bool kcompactd_work_requested(pg_data_t *pgdat)
+{
+	return pgdat->kcompactd_wake || kthread_should_stop();
+}
+
+static int kcompactd(void *p)
+{
+	pg_data_t *pgdat = (pg_data_t *)p;
+	const struct cpumask *cpumask = cpumask_of_node(pgdat->node_id);
+
+	if (!cpumask_empty(cpumask))
+		set_cpus_allowed_ptr(current, cpumask);
+
+	/* Background work, whatever else wants the cpu goes first */
+	set_user_nice(current, 19);
+	set_freezable();
+
+	while (!kthread_should_stop()) {
+		wait_event_freezable(pgdat->kcompactd_wait,
+				     kcompactd_work_requested(pgdat));
+		if (kthread_should_stop())
+			break;
+
+		pgdat->kcompactd_wake = false;
+		kcompactd_do_work(pgdat);
+	}
+
+	return 0;
+}
+
+/*
+ * This kcompactd start function will be called by init and node-hot-add.
+ */
+int kcompactd_run(int nid)
+{
+	pg_data_t *pgdat = NODE_DATA(nid);
+	int ret = 0;
+
+	if (pgdat->kcompactd)
+		return 0;
+
+	pgdat->kcompactd = kthread_run(kcompactd, pgdat, "kcompactd%d", nid);
+	if (IS_ERR(pgdat->kcompactd)) {
+		printk(KERN_ERR "Failed to start kcompactd on node %d\n", nid);
+		pgdat->kcompactd = NULL;
+		ret = -1;
+	}
+	return ret;
+}
+
+/*
+ * Called by memory hotplug when all memory in a node is offlined.  Caller must
+ * hold lock_memory_hotplug().
+ */
+void kcompactd_stop(int nid)
+{
+	struct task_struct *kcompactd = NODE_DATA(nid)->kcompactd;
+
+	if (kcompactd) {
+		kthread_stop(kcompactd);
+		NODE_DATA(nid)->kcompactd = NULL;
+	}
+}
+
+static int __init kcompactd_init(void)
+{
+	int nid;
+
+	for_each_node_state(nid, N_HIGH_MEMORY)
+		kcompactd_run(nid);
+	return 0;
+}
+module_init(kcompactd_init)
+
 #if defined(CONFIG_SYSFS) && defined(CONFIG_NUMA)
 ssize_t sysfs_compact_node(struct sys_device *dev,
 			struct sysdev_attribute *attr,
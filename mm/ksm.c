@@ -223,6 +223,10 @@ static unsigned int ksm_thread_pages_to_scan = 100;
 /* Milliseconds ksmd should sleep between batches */
 static unsigned int ksm_thread_sleep_millisecs = 20;
 
+/* Full scans between scans of a vma that has stopped merging, at most */
+#define KSM_MAX_IDLE_SCANS	6
+static unsigned int ksm_max_scan_interval = 8;
+
 #ifdef CONFIG_NUMA
 /* Zeroed when merging across nodes is not allowed */
 static unsigned int ksm_merge_across_nodes = 1;
@@ -832,11 +836,31 @@ error:
 }
 #endif /* CONFIG_SYSFS */
 
+/*
+ * The checksum only tells whether a page changed since it was last
+ * scanned: pages are compared in full before they are merged.  So
+ * rather than the whole page, hash KSM_CHECKSUM_CHUNKS cache lines
+ * spread over it, each at a different offset within its stretch of the
+ * page, so that an array of structures is not always sampled at the
+ * same field.
+ */
+#define KSM_CHECKSUM_CHUNKS	8
+#define KSM_CHECKSUM_CHUNK	64
+#define KSM_CHECKSUM_STRETCH	(PAGE_SIZE / KSM_CHECKSUM_CHUNKS)
+
 static u32 calc_checksum(struct page *page)
 {
-	u32 checksum;
+	u32 checksum = 17;
 	void *addr = kmap_atomic(page, KM_USER0);
-	checksum = jhash2(addr, PAGE_SIZE / 4, 17);
+	unsigned int i, offset;
+
+	for (i = 0; i < KSM_CHECKSUM_CHUNKS; i++) {
+		offset = i * KSM_CHECKSUM_STRETCH +
+			 (i * 5) % (KSM_CHECKSUM_STRETCH / KSM_CHECKSUM_CHUNK) *
+			 KSM_CHECKSUM_CHUNK;
+		checksum = jhash2(addr + offset, KSM_CHECKSUM_CHUNK / 4,
+				  checksum);
+	}
 	kunmap_atomic(addr, KM_USER0);
 	return checksum;
 }
@@ -1059,6 +1083,9 @@ static int try_to_merge_one_page(struct vm_area_struct *vma,
 			err = replace_page(vma, page, kpage, orig_pte);
 	}
 
+	if (!err)
+		vma->ksm_merged++;
+
 	if ((vma->vm_flags & VM_LOCKED) && kpage && !err) {
 		munlock_vma_page(page);
 		if (!PageMlocked(kpage)) {
@@ -1533,6 +1560,55 @@ static struct rmap_item *get_next_rmap_item(struct mm_slot *mm_slot,
 	return rmap_item;
 }
 
+/*
+ * A vma whose pages stopped merging is scanned only every other full
+ * scan, then every fourth, and so on up to every ksm_max_scan_interval:
+ * the pages_to_scan budget goes to the areas which merge first.  When a
+ * vma is due, its last scan is judged by whether anything merged since.
+ */
+static bool ksm_vma_due(struct vm_area_struct *vma)
+{
+	unsigned long interval;
+
+	interval = min_t(unsigned long, 1UL << vma->ksm_idle_scans,
+			 ksm_max_scan_interval);
+	if (ksm_scan.seqnr & (interval - 1))
+		return false;
+
+	if (vma->ksm_merged != vma->ksm_merged_mark)
+		vma->ksm_idle_scans = 0;
+	else if (vma->ksm_scanned && vma->ksm_idle_scans < KSM_MAX_IDLE_SCANS)
+		vma->ksm_idle_scans++;
+	vma->ksm_merged_mark = vma->ksm_merged;
+	return true;
+}
+
+/*
+ * Move the scan cursor past a vma that is not due, keeping its
+ * rmap_items and their checksums for the scan it is due in.  Its
+ * unstable rmap_items are taken out of the last full scan's tree just
+ * as scanning them would have.
+ */
+static void ksm_skip_vma(struct vm_area_struct *vma)
+{
+	struct rmap_item *rmap_item;
+
+	while ((rmap_item = *ksm_scan.rmap_list) &&
+	       rmap_item->address < vma->vm_end) {
+		if (rmap_item->address < vma->vm_start) {
+			/* no vma there any more, as in get_next_rmap_item */
+			*ksm_scan.rmap_list = rmap_item->rmap_list;
+			remove_rmap_item_from_tree(rmap_item);
+			free_rmap_item(rmap_item);
+			continue;
+		}
+		if (rmap_item->address & UNSTABLE_FLAG)
+			remove_rmap_item_from_tree(rmap_item);
+		ksm_scan.rmap_list = &rmap_item->rmap_list;
+	}
+	ksm_scan.address = vma->vm_end;
+}
+
 static struct rmap_item *scan_get_next_rmap_item(struct page **page)
 {
 	struct mm_struct *mm;
@@ -1611,6 +1687,11 @@ next_mm:
 			ksm_scan.address = vma->vm_start;
 		if (!vma->anon_vma)
 			ksm_scan.address = vma->vm_end;
+		else if (ksm_scan.address == vma->vm_start &&
+			 !ksm_vma_due(vma)) {
+			ksm_skip_vma(vma);
+			continue;
+		}
 
 		while (ksm_scan.address < vma->vm_end) {
 			if (ksm_test_exit(mm))
@@ -1631,6 +1712,7 @@ next_mm:
 					ksm_scan.rmap_list =
 							&rmap_item->rmap_list;
 					ksm_scan.address += PAGE_SIZE;
+					vma->ksm_scanned++;
 				} else
 					put_page(*page);
 				up_read(&mm->mmap_sem);
@@ -2288,6 +2370,29 @@ static ssize_t pages_to_scan_store(struct kobject *kobj,
 }
 KSM_ATTR(pages_to_scan);
 
+static ssize_t max_scan_interval_show(struct kobject *kobj,
+				      struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u\n", ksm_max_scan_interval);
+}
+
+static ssize_t max_scan_interval_store(struct kobject *kobj,
+				       struct kobj_attribute *attr,
+				       const char *buf, size_t count)
+{
+	unsigned long interval;
+	int err;
+
+	err = kstrtoul(buf, 10, &interval);
+	if (err || !interval || interval > 1UL << KSM_MAX_IDLE_SCANS)
+		return -EINVAL;
+
+	ksm_max_scan_interval = rounddown_pow_of_two(interval);
+
+	return count;
+}
+KSM_ATTR(max_scan_interval);
+
 static ssize_t run_show(struct kobject *kobj, struct kobj_attribute *attr,
 			char *buf)
 {
@@ -2465,6 +2570,7 @@ KSM_ATTR_RO(full_scans);
 static struct attribute *ksm_attrs[] = {
 	&sleep_millisecs_attr.attr,
 	&pages_to_scan_attr.attr,
+	&max_scan_interval_attr.attr,
 	&run_attr.attr,
 	&pages_shared_attr.attr,
 	&pages_sharing_attr.attr,
@@ -608,8 +608,8 @@ static inline int free_pages_check(struct page *page)
 
 /*
  * Frees a number of pages from the PCP lists
- * Assumes all pages on list are in same zone, and of same order.
- * count is the number of pages to free.
+ * Assumes all pages on list are in same zone, and of the given order.
+ * count is the number of pages, or blocks of that order, to free.
  *
  * If the zone was previously in an "all pages pinned" state then look to
  * see if this freeing clears that state.
@@ -618,7 +618,7 @@ static inline int free_pages_check(struct page *page)
  * pinned" detection logic.
  */
 static void free_pcppages_bulk(struct zone *zone, int count,
-					struct per_cpu_pages *pcp)
+				struct per_cpu_pages *pcp, unsigned int order)
 {
 	int migratetype = 0;
 	int batch_free = 0;
@@ -655,11 +655,12 @@ static void free_pcppages_bulk(struct zone *zone, int count,
 			/* must delete as __free_one_page list manipulates */
 			list_del(&page->lru);
 			/* MIGRATE_MOVABLE list may include MIGRATE_RESERVEs */
-			__free_one_page(page, zone, 0, page_private(page));
-			trace_mm_page_pcpu_drain(page, 0, page_private(page));
+			__free_one_page(page, zone, order, page_private(page));
+			trace_mm_page_pcpu_drain(page, order,
+						 page_private(page));
 		} while (--to_free && --batch_free && !list_empty(list));
 	}
-	__mod_zone_page_state(zone, NR_FREE_PAGES, count);
+	__mod_zone_page_state(zone, NR_FREE_PAGES, count << order);
 	spin_unlock(&zone->lock);
 }
 
@@ -701,20 +702,37 @@ static bool free_pages_prepare(struct page *page, unsigned int order)
 	return true;
 }
 
+static void free_pcp_page(struct zone *zone, struct page *page,
+			  unsigned int order, int migratetype, int cold);
+
 static void __free_pages_ok(struct page *page, unsigned int order)
 {
 	unsigned long flags;
 	int wasMlocked = __TestClearPageMlocked(page);
+	int migratetype;
 
 	if (!free_pages_prepare(page, order))
 		return;
 
+	/* Blocks on the per-cpu lists must not stay compound */
+	if (order <= PCP_MAX_ORDER && unlikely(PageCompound(page)))
+		if (unlikely(destroy_compound_page(page, order)))
+			return;
+
+	migratetype = get_pageblock_migratetype(page);
 	local_irq_save(flags);
 	if (unlikely(wasMlocked))
 		free_page_mlock(page);
 	__count_vm_events(PGFREE, 1 << order);
-	free_one_page(page_zone(page), page, order,
-					get_pageblock_migratetype(page));
+	/* As in free_hot_cold_page() */
+	if (order > PCP_MAX_ORDER || migratetype == MIGRATE_ISOLATE) {
+		free_one_page(page_zone(page), page, order, migratetype);
+	} else {
+		set_page_private(page, migratetype);
+		if (migratetype >= MIGRATE_PCPTYPES)
+			migratetype = MIGRATE_MOVABLE;
+		free_pcp_page(page_zone(page), page, order, migratetype, 0);
+	}
 	local_irq_restore(flags);
 }
 
@@ -1079,6 +1097,28 @@ static int rmqueue_bulk(struct zone *zone, unsigned int order,
 	return i;
 }
 
+/* The per-cpu list of @pset for blocks of @order */
+static inline struct per_cpu_pages *pageset_pcp(struct per_cpu_pageset *pset,
+						unsigned int order)
+{
+	return order ? &pset->pcp_order[order - 1] : &pset->pcp;
+}
+
+/* Free every page and block on the lists of @pset */
+static void free_pageset(struct zone *zone, struct per_cpu_pageset *pset)
+{
+	unsigned int order;
+
+	for (order = 0; order <= PCP_MAX_ORDER; order++) {
+		struct per_cpu_pages *pcp = pageset_pcp(pset, order);
+
+		if (pcp->count) {
+			free_pcppages_bulk(zone, pcp->count, pcp, order);
+			pcp->count = 0;
+		}
+	}
+}
+
 #ifdef CONFIG_NUMA
 /*
  * Called from the vmstat counter updater to drain pagesets of this
@@ -1088,18 +1128,25 @@ static int rmqueue_bulk(struct zone *zone, unsigned int order,
  * Note that this function must be called with the thread pinned to
  * a single processor.
  */
-void drain_zone_pages(struct zone *zone, struct per_cpu_pages *pcp)
+void drain_zone_pages(struct zone *zone, struct per_cpu_pageset *pset)
 {
 	unsigned long flags;
+	unsigned int order;
 	int to_drain;
 
 	local_irq_save(flags);
-	if (pcp->count >= pcp->batch)
-		to_drain = pcp->batch;
-	else
-		to_drain = pcp->count;
-	free_pcppages_bulk(zone, to_drain, pcp);
-	pcp->count -= to_drain;
+	for (order = 0; order <= PCP_MAX_ORDER; order++) {
+		struct per_cpu_pages *pcp = pageset_pcp(pset, order);
+
+		if (pcp->count >= pcp->batch)
+			to_drain = pcp->batch;
+		else
+			to_drain = pcp->count;
+		if (!to_drain)
+			continue;
+		free_pcppages_bulk(zone, to_drain, pcp, order);
+		pcp->count -= to_drain;
+	}
 	local_irq_restore(flags);
 }
 #endif
@@ -1118,16 +1165,10 @@ static void drain_pages(unsigned int cpu)
 
 	for_each_populated_zone(zone) {
 		struct per_cpu_pageset *pset;
-		struct per_cpu_pages *pcp;
 
 		local_irq_save(flags);
 		pset = per_cpu_ptr(zone->pageset, cpu);
-
-		pcp = &pset->pcp;
-		if (pcp->count) {
-			free_pcppages_bulk(zone, pcp->count, pcp);
-			pcp->count = 0;
-		}
+		free_pageset(zone, pset);
 		local_irq_restore(flags);
 	}
 }
@@ -1184,6 +1225,28 @@ void mark_free_pages(struct zone *zone)
 }
 #endif /* CONFIG_PM */
 
+/*
+ * Put a page, or a block of up to PCP_MAX_ORDER, on this cpu's list for
+ * @order, and give a batch back to the buddy allocator once the list
+ * reaches pcp->high.  Interrupts must be disabled.
+ */
+static void free_pcp_page(struct zone *zone, struct page *page,
+			  unsigned int order, int migratetype, int cold)
+{
+	struct per_cpu_pages *pcp;
+
+	pcp = pageset_pcp(this_cpu_ptr(zone->pageset), order);
+	if (cold)
+		list_add_tail(&page->lru, &pcp->lists[migratetype]);
+	else
+		list_add(&page->lru, &pcp->lists[migratetype]);
+	pcp->count++;
+	if (pcp->count >= pcp->high) {
+		free_pcppages_bulk(zone, pcp->batch, pcp, order);
+		pcp->count -= pcp->batch;
+	}
+}
+
 /*
  * Free a 0-order page
  * cold == 1 ? free a cold page : free a hot page
@@ -1191,7 +1254,6 @@ void mark_free_pages(struct zone *zone)
 void free_hot_cold_page(struct page *page, int cold)
 {
 	struct zone *zone = page_zone(page);
-	struct per_cpu_pages *pcp;
 	unsigned long flags;
 	int migratetype;
 	int wasMlocked = __TestClearPageMlocked(page);
@@ -1221,16 +1283,7 @@ void free_hot_cold_page(struct page *page, int cold)
 		migratetype = MIGRATE_MOVABLE;
 	}
 
-	pcp = &this_cpu_ptr(zone->pageset)->pcp;
-	if (cold)
-		list_add_tail(&page->lru, &pcp->lists[migratetype]);
-	else
-		list_add(&page->lru, &pcp->lists[migratetype]);
-	pcp->count++;
-	if (pcp->count >= pcp->high) {
-		free_pcppages_bulk(zone, pcp->batch, pcp);
-		pcp->count -= pcp->batch;
-	}
+	free_pcp_page(zone, page, 0, migratetype, cold);
 
 out:
 	local_irq_restore(flags);
@@ -1324,15 +1377,29 @@ struct page *buffered_rmqueue(struct zone *preferred_zone,
 	int cold = !!(gfp_flags & __GFP_COLD);
 
 again:
-	if (likely(order == 0)) {
+	if (unlikely(order && (gfp_flags & __GFP_NOFAIL))) {
+		/*
+		 * __GFP_NOFAIL is not to be used in new code.
+		 *
+		 * All __GFP_NOFAIL callers should be fixed so that they
+		 * properly detect and handle allocation failures.
+		 *
+		 * We most definitely don't want callers attempting to
+		 * allocate greater than order-1 page units with
+		 * __GFP_NOFAIL.
+		 */
+		WARN_ON_ONCE(order > 1);
+	}
+
+	if (likely(order <= PCP_MAX_ORDER)) {
 		struct per_cpu_pages *pcp;
 		struct list_head *list;
 
 		local_irq_save(flags);
-		pcp = &this_cpu_ptr(zone->pageset)->pcp;
+		pcp = pageset_pcp(this_cpu_ptr(zone->pageset), order);
 		list = &pcp->lists[migratetype];
 		if (list_empty(list)) {
-			pcp->count += rmqueue_bulk(zone, 0,
+			pcp->count += rmqueue_bulk(zone, order,
 					pcp->batch, list,
 					migratetype, cold);
 			if (unlikely(list_empty(list)))
@@ -1347,19 +1414,6 @@ again:
 		list_del(&page->lru);
 		pcp->count--;
 	} else {
-		if (unlikely(gfp_flags & __GFP_NOFAIL)) {
-			/*
-			 * __GFP_NOFAIL is not to be used in new code.
-			 *
-			 * All __GFP_NOFAIL callers should be fixed so that they
-			 * properly detect and handle allocation failures.
-			 *
-			 * We most definitely don't want callers attempting to
-			 * allocate greater than order-1 page units with
-			 * __GFP_NOFAIL.
-			 */
-			WARN_ON_ONCE(order > 1);
-		}
 		spin_lock_irqsave(&zone->lock, flags);
 		page = __rmqueue(zone, order, migratetype);
 		spin_unlock(&zone->lock);
@@ -2442,6 +2496,93 @@ void free_pages(unsigned long addr, unsigned int order)
 
 EXPORT_SYMBOL(free_pages);
 
+static struct page *__page_frag_refill(struct page_frag_cache *nc,
+				       gfp_t gfp_mask)
+{
+	struct page *page = NULL;
+
+	if (PAGE_FRAG_CACHE_MAX_ORDER)
+		page = alloc_pages(gfp_mask | __GFP_COMP | __GFP_NOWARN |
+				   __GFP_NORETRY | __GFP_NOMEMALLOC,
+				   PAGE_FRAG_CACHE_MAX_ORDER);
+	nc->size = page ? PAGE_FRAG_CACHE_MAX_SIZE : PAGE_SIZE;
+	if (unlikely(!page))
+		page = alloc_pages(gfp_mask, 0);
+
+	nc->va = page ? page_address(page) : NULL;
+	return page;
+}
+
+/**
+ * __alloc_page_frag - allocate a fragment of a page
+ * @nc: the fragment cache to carve from
+ * @fragsz: size of the fragment, at most PAGE_SIZE
+ * @gfp_mask: GFP flags for refilling @nc, which must not ask for highmem
+ *
+ * Carve @fragsz bytes out of the page held by @nc, refilling it with a
+ * PAGE_FRAG_CACHE_MAX_SIZE compound page if possible, or an order 0 one
+ * if not.  Each fragment holds a reference to the page, dropped by
+ * __free_page_frag() or put_page() on virt_to_head_page().  When all of
+ * a page has been handed out, and all of it has been freed already, the
+ * page is reused without going back to the page allocator.
+ *
+ * The caller serializes access to @nc, typically by keeping one per cpu
+ * and disabling interrupts around the call.
+ */
+void *__alloc_page_frag(struct page_frag_cache *nc, unsigned int fragsz,
+			gfp_t gfp_mask)
+{
+	struct page *page;
+	int offset;
+
+	if (unlikely(!nc->va)) {
+refill:
+		page = __page_frag_refill(nc, gfp_mask);
+		if (!page)
+			return NULL;
+
+		/*
+		 * Even if we own the page, do not use atomic_set():
+		 * that would break get_page_unless_zero() users.
+		 */
+		atomic_add(nc->size - 1, &page->_count);
+		nc->pagecnt_bias = nc->size;
+		nc->offset = nc->size;
+	}
+
+	offset = nc->offset - fragsz;
+	if (unlikely(offset < 0)) {
+		page = virt_to_page(nc->va);
+
+		if (!atomic_sub_and_test(nc->pagecnt_bias, &page->_count))
+			goto refill;
+
+		/* Every fragment is back: the page count is ours to set */
+		atomic_set(&page->_count, nc->size);
+		nc->pagecnt_bias = nc->size;
+		offset = nc->size - fragsz;
+	}
+
+	nc->pagecnt_bias--;
+	nc->offset = offset;
+
+	return nc->va + offset;
+}
+EXPORT_SYMBOL(__alloc_page_frag);
+
+/**
+ * __free_page_frag - free a fragment from __alloc_page_frag()
+ * @addr: address of the fragment
+ */
+void __free_page_frag(void *addr)
+{
+	struct page *page = virt_to_head_page(addr);
+
+	if (unlikely(put_page_testzero(page)))
+		__free_pages_ok(page, compound_order(page));
+}
+EXPORT_SYMBOL(__free_page_frag);
+
 static void *make_alloc_exact(unsigned long addr, unsigned order, size_t size)
 {
 	if (addr) {
@@ -2627,7 +2768,7 @@ out:
  */
 void show_free_areas(unsigned int filter)
 {
-	int cpu;
+	int cpu, order;
 	struct zone *zone;
 
 	for_each_populated_zone(zone) {
@@ -2641,9 +2782,13 @@ void show_free_areas(unsigned int filter)
 
 			pageset = per_cpu_ptr(zone->pageset, cpu);
 
-			printk("CPU %4d: hi:%5d, btch:%4d usd:%4d\n",
+			printk("CPU %4d: hi:%5d, btch:%4d usd:%4d",
 			       cpu, pageset->pcp.high,
 			       pageset->pcp.batch, pageset->pcp.count);
+			for (order = 1; order <= PCP_MAX_ORDER; order++)
+				printk(" o%d usd:%4d", order,
+				       pageset->pcp_order[order - 1].count);
+			printk("\n");
 		}
 	}
 
@@ -3658,9 +3803,38 @@ static int zone_batchsize(struct zone *zone)
 #endif
 }
 
+/*
+ * The high-order lists are tuned by vm.percpu_pagelist_order_high and
+ * vm.percpu_pagelist_order_batch, in blocks.  Left at 0, an order takes
+ * batch >> (order + 1) blocks at a time and keeps four batches at most:
+ * 7/28, 3/12 and 1/4 blocks of order 1, 2 and 3 for a batch of 31 pages,
+ * 136 pages in all.
+ */
+int percpu_pagelist_order_high[PCP_MAX_ORDER];
+int percpu_pagelist_order_batch[PCP_MAX_ORDER];
+
+static void setup_pagelist_order(struct per_cpu_pages *pcp,
+				 unsigned int order, unsigned long zone_batch)
+{
+	unsigned long high = percpu_pagelist_order_high[order - 1];
+	unsigned long batch = percpu_pagelist_order_batch[order - 1];
+
+	if (high) {
+		pcp->high = high;
+		pcp->batch = max(1UL, high/4);
+	} else {
+		pcp->batch = max(1UL, zone_batch >> (order + 1));
+		pcp->high = zone_batch ? 4 * pcp->batch : 0;
+	}
+	/* a batch larger than the list would drain it on every free */
+	if (batch && pcp->high)
+		pcp->batch = min(batch, (unsigned long)pcp->high);
+}
+
 static void setup_pageset(struct per_cpu_pageset *p, unsigned long batch)
 {
 	struct per_cpu_pages *pcp;
+	unsigned int order;
 	int migratetype;
 
 	memset(p, 0, sizeof(*p));
@@ -3671,6 +3845,14 @@ static void setup_pageset(struct per_cpu_pageset *p, unsigned long batch)
 	pcp->batch = max(1UL, 1 * batch);
 	for (migratetype = 0; migratetype < MIGRATE_PCPTYPES; migratetype++)
 		INIT_LIST_HEAD(&pcp->lists[migratetype]);
+
+	for (order = 1; order <= PCP_MAX_ORDER; order++) {
+		pcp = &p->pcp_order[order - 1];
+		setup_pagelist_order(pcp, order, batch);
+		for (migratetype = 0; migratetype < MIGRATE_PCPTYPES;
+		     migratetype++)
+			INIT_LIST_HEAD(&pcp->lists[migratetype]);
+	}
 }
 
 /*
@@ -3771,13 +3953,11 @@ static int __zone_pcp_update(void *data)
 
 	for_each_possible_cpu(cpu) {
 		struct per_cpu_pageset *pset;
-		struct per_cpu_pages *pcp;
 
 		pset = per_cpu_ptr(zone->pageset, cpu);
-		pcp = &pset->pcp;
 
 		local_irq_save(flags);
-		free_pcppages_bulk(zone, pcp->count, pcp);
+		free_pageset(zone, pset);
 		setup_pageset(pset, batch);
 		local_irq_restore(flags);
 	}
@@ -4386,6 +4566,9 @@ static void __paginginit free_area_init_core(struct pglist_data *pgdat,
 	pgdat->nr_zones = 0;
 	init_waitqueue_head(&pgdat->kswapd_wait);
 	pgdat->kswapd_max_order = 0;
+#ifdef CONFIG_COMPACTION
+	init_waitqueue_head(&pgdat->kcompactd_wait);
+#endif
 	pgdat_page_cgroup_init(pgdat);
 	
 	for (j = 0; j < MAX_NR_ZONES; j++) {
@@ -4443,6 +4626,7 @@ static void __paginginit free_area_init_core(struct pglist_data *pgdat,
 		zone_pcp_init(zone);
 		for_each_lru(l)
 			INIT_LIST_HEAD(&zone->lru[l].list);
+		lru_gen_init_zone(zone);
 		zone->reclaim_stat.recent_rotated[0] = 0;
 		zone->reclaim_stat.recent_rotated[1] = 0;
 		zone->reclaim_stat.recent_scanned[0] = 0;
@@ -5413,6 +5597,37 @@ int percpu_pagelist_fraction_sysctl_handler(ctl_table *table, int write,
 	return 0;
 }
 
+/*
+ * percpu_pagelist_order_high and percpu_pagelist_order_batch - set
+ * pcp->high and pcp->batch, in blocks, of the per cpu lists of each order
+ * from 1 to PCP_MAX_ORDER, in each zone on each cpu.  0 restores the
+ * default for that order.
+ */
+int percpu_pagelist_order_sysctl_handler(ctl_table *table, int write,
+	void __user *buffer, size_t *length, loff_t *ppos)
+{
+	struct zone *zone;
+	unsigned int cpu, order;
+	int ret;
+
+	ret = proc_dointvec_minmax(table, write, buffer, length, ppos);
+	if (!write || (ret == -EINVAL))
+		return ret;
+	for_each_populated_zone(zone) {
+		unsigned long batch = zone_batchsize(zone);
+
+		for_each_possible_cpu(cpu) {
+			struct per_cpu_pageset *pset;
+
+			pset = per_cpu_ptr(zone->pageset, cpu);
+			for (order = 1; order <= PCP_MAX_ORDER; order++)
+				setup_pagelist_order(&pset->pcp_order[order - 1],
+						     order, batch);
+		}
+	}
+	return 0;
+}
+
 int hashdist = HASHDIST_DEFAULT;
 
 #ifdef CONFIG_NUMA
@@ -177,7 +177,7 @@ __do_page_cache_readahead(struct address_space *mapping, struct file *filp,
 		rcu_read_lock();
 		page = radix_tree_lookup(&mapping->page_tree, page_offset);
 		rcu_read_unlock();
-		if (page)
+		if (page && !radix_tree_exceptional_entry(page))
 			continue;
 
 		page = page_cache_alloc_readahead(mapping);
@@ -255,6 +255,8 @@ unsigned long ra_submit(struct file_ra_state *ra,
 
 	actual = __do_page_cache_readahead(mapping, filp,
 					ra->start, ra->size, ra->async_size);
+	if (actual > 0)
+		add_bdi_stat(mapping->backing_dev_info, BDI_READAHEAD, actual);
 
 	return actual;
 }
@@ -290,9 +292,9 @@ static unsigned long get_next_ra_size(struct file_ra_state *ra,
 	unsigned long newsize;
 
 	if (cur < (max >> 4))
-		newsize = cur >> 2;
+		newsize = cur << 2;
 	else
-		newsize = cur >> 1;
+		newsize = cur << 1;
 
 	return min(newsize, max);
 }
@@ -334,8 +336,93 @@ static unsigned long get_next_ra_size(struct file_ra_state *ra,
  *
  * The code ramps up the readahead size aggressively at first, but slow down as
  * it approaches max_readhead.
+ *
+ * Each file is classified by the way it has been read so far:
+ *
+ * - sequential: the reader keeps arriving at the expected offset. After
+ *   RA_SEQ_HITS windows in a row have been used up, the window may grow
+ *   past ra_pages, see ra_seq_max().
+ * - strided: two cache misses in a row land the same number of pages
+ *   past the end of the previous request. The following blocks at that
+ *   stride are read along with the missing one, see strided_readahead().
+ * - interleaved: a PG_readahead marker or the page cache history shows
+ *   a stream the readahead state has lost track of.
+ * - random: RA_RANDOM_MISSES small reads in a row fitted none of the
+ *   above. Only the requested pages are read from then on, until as
+ *   many sequential misses have been seen again.
+ *
+ * The pages submitted by readahead and the pages of windows that were
+ * used up are accounted to the bdi as BDI_READAHEAD and BDI_READAHEAD_HIT.
  */
 
+#define RA_PATTERN_NONE		0
+#define RA_PATTERN_SEQUENTIAL	1
+#define RA_PATTERN_STRIDED	2
+#define RA_PATTERN_INTERLEAVED	3
+#define RA_PATTERN_RANDOM	4
+
+#define RA_RANDOM_MISSES	4	/* small random reads before giving up */
+#define RA_SEQ_HITS		8	/* used windows per doubling of max */
+#define RA_SEQ_SHIFT		2	/* grow up to 4 times ra_pages */
+#define RA_HITS_MAX		((1 << RA_SEQ_SHIFT) * RA_SEQ_HITS)
+
+/*
+ * A stream that keeps using up whole windows is allowed to read further
+ * ahead than the bdi default: twice as far after RA_SEQ_HITS windows, and
+ * up to 1 << RA_SEQ_SHIFT times as far. That only pays off while most of
+ * what is read ahead on the bdi gets used and the device keeps up, so
+ * stay at @max otherwise.
+ */
+static unsigned long ra_seq_max(struct backing_dev_info *bdi,
+				struct file_ra_state *ra, unsigned long max)
+{
+	unsigned int shift = min(ra->hits / RA_SEQ_HITS, RA_SEQ_SHIFT);
+
+	if (!shift || bdi_read_congested(bdi))
+		return max;
+
+	if (bdi_stat(bdi, BDI_READAHEAD_HIT) * 4 <
+	    bdi_stat(bdi, BDI_READAHEAD) * 3)
+		return max;
+
+	return max_sane_readahead(max << shift);
+}
+
+static unsigned long ra_stride_blocks(struct file_ra_state *ra,
+				      unsigned long max)
+{
+	return max(max / ra->size, 1UL);
+}
+
+/*
+ * Read as many blocks of ra->size pages, ra->stride pages apart, as fit
+ * into @max, starting with the one at ra->start. The first page of the
+ * last block is marked with PG_readahead, and ra->start is left pointing
+ * at it, so that the next batch is read asynchronously once the reader
+ * gets there.
+ */
+static unsigned long strided_readahead(struct address_space *mapping,
+				       struct file_ra_state *ra,
+				       struct file *filp, unsigned long max)
+{
+	unsigned long nr = ra_stride_blocks(ra, max);
+	unsigned long actual = 0;
+
+	for (;;) {
+		actual += __do_page_cache_readahead(mapping, filp, ra->start,
+					ra->size, nr == 1 ? ra->size : 0);
+		if (!--nr)
+			break;
+		ra->start += ra->size + ra->stride;
+	}
+	ra->async_size = ra->size;
+
+	if (actual)
+		add_bdi_stat(mapping->backing_dev_info, BDI_READAHEAD, actual);
+
+	return actual;
+}
+
 /*
  * Count contiguously cached pages from @offset-1 to @offset-@max,
  * this count is a conservative estimation of
@@ -349,7 +436,7 @@ static pgoff_t count_history_pages(struct address_space *mapping,
 	pgoff_t head;
 
 	rcu_read_lock();
-	head = radix_tree_prev_hole(&mapping->page_tree, offset - 1, max);
+	head = page_cache_prev_hole(mapping, offset - 1, max);
 	rcu_read_unlock();
 
 	return offset - 1 - head;
@@ -398,7 +485,35 @@ ondemand_readahead(struct address_space *mapping,
 		   bool hit_readahead_marker, pgoff_t offset,
 		   unsigned long req_size)
 {
+	struct backing_dev_info *bdi = mapping->backing_dev_info;
 	unsigned long max = max_sane_readahead(ra->ra_pages);
+	pgoff_t prev_offset = ra->prev_pos >> PAGE_CACHE_SHIFT;
+
+	/*
+	 * The reader got to the last block of a strided batch,
+	 * read the next one.
+	 */
+	if (hit_readahead_marker && ra->pattern == RA_PATTERN_STRIDED &&
+	    offset == ra->start) {
+		add_bdi_stat(bdi, BDI_READAHEAD_HIT,
+			     ra_stride_blocks(ra, max) * ra->size);
+		ra->start += ra->size + ra->stride;
+		return strided_readahead(mapping, ra, filp, max);
+	}
+
+	/*
+	 * Random reads get no readahead until the file is read
+	 * sequentially again for a while.
+	 */
+	if (!hit_readahead_marker && ra->pattern == RA_PATTERN_RANDOM) {
+		if (offset - prev_offset <= 1UL) {
+			if (!--ra->misses)
+				ra->pattern = RA_PATTERN_NONE;
+		} else if (ra->misses < RA_RANDOM_MISSES)
+			ra->misses++;
+		return __do_page_cache_readahead(mapping, filp, offset,
+						 req_size, 0);
+	}
 
 	/*
 	 * start of file
@@ -412,12 +527,20 @@ ondemand_readahead(struct address_space *mapping,
 	 */
 	if ((offset == (ra->start + ra->size - ra->async_size) ||
 	     offset == (ra->start + ra->size))) {
+		if (hit_readahead_marker || offset == ra->start + ra->size)
+			add_bdi_stat(bdi, BDI_READAHEAD_HIT, ra->size);
+		if (ra->hits < RA_HITS_MAX)
+			ra->hits++;
+		ra->pattern = RA_PATTERN_SEQUENTIAL;
+		max = ra_seq_max(bdi, ra, max);
 		ra->start += ra->size;
 		ra->size = get_next_ra_size(ra, max);
 		ra->async_size = ra->size;
 		goto readit;
 	}
 
+	ra->hits = 0;
+
 	/*
 	 * Hit a marked page without valid readahead state.
 	 * E.g. interleaved reads.
@@ -428,12 +551,14 @@ ondemand_readahead(struct address_space *mapping,
 		pgoff_t start;
 
 		rcu_read_lock();
-		start = radix_tree_next_hole(&mapping->page_tree, offset+1,max);
+		start = page_cache_next_hole(mapping, offset + 1, max);
 		rcu_read_unlock();
 
 		if (!start || start - offset > max)
 			return 0;
 
+		add_bdi_stat(bdi, BDI_READAHEAD_HIT, start - offset);
+		ra->pattern = RA_PATTERN_INTERLEAVED;
 		ra->start = start;
 		ra->size = start - offset;	/* old async_size */
 		ra->size += req_size;
@@ -451,28 +576,53 @@ ondemand_readahead(struct address_space *mapping,
 	/*
 	 * sequential cache miss
 	 */
-	if (offset - (ra->prev_pos >> PAGE_CACHE_SHIFT) <= 1UL)
+	if (offset - prev_offset <= 1UL)
 		goto initial_readahead;
 
+	/*
+	 * The second miss in a row at the same distance past the end of
+	 * the previous request: strided access.
+	 */
+	if (offset > prev_offset && offset - prev_offset <= max) {
+		unsigned long stride = offset - prev_offset - 1;
+
+		if (stride == ra->stride) {
+			ra->pattern = RA_PATTERN_STRIDED;
+			ra->misses = 0;
+			ra->start = offset;
+			ra->size = req_size;
+			return strided_readahead(mapping, ra, filp, max);
+		}
+		ra->stride = stride;
+	} else
+		ra->stride = 0;
+
 	/*
 	 * Query the page cache and look for the traces(cached history pages)
 	 * that a sequential stream would leave behind.
 	 */
-	if (try_context_readahead(mapping, ra, offset, req_size, max))
+	if (try_context_readahead(mapping, ra, offset, req_size, max)) {
+		ra->pattern = RA_PATTERN_INTERLEAVED;
 		goto readit;
+	}
 
 	/*
 	 * standalone, small random read
 	 * Read as is, and do not pollute the readahead state.
 	 */
+	if (++ra->misses >= RA_RANDOM_MISSES)
+		ra->pattern = RA_PATTERN_RANDOM;
 	return __do_page_cache_readahead(mapping, filp, offset, req_size, 0);
 
 initial_readahead:
+	ra->pattern = RA_PATTERN_SEQUENTIAL;
 	ra->start = offset;
 	ra->size = get_init_ra_size(req_size, max);
 	ra->async_size = ra->size > req_size ? ra->size - req_size : ra->size;
 
 readit:
+	ra->misses = 0;
+
 	/*
 	 * Will this read hit the readahead marker made by itself?
 	 * If so, trigger the readahead marker hit now, and merge
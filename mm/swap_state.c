@@ -20,6 +20,8 @@
 #include <linux/pagevec.h>
 #include <linux/migrate.h>
 #include <linux/page_cgroup.h>
+#include <linux/kobject.h>
+#include <linux/sysfs.h>
 
 #include <asm/pgtable.h>
 
@@ -255,33 +257,77 @@ void free_pages_and_swap_cache(struct page **pages, int nr)
 	}
 }
 
+/*
+ * vma->swap_readahead_info packs the page address of the last swap
+ * fault in the vma with the readahead window used for it and the number
+ * of readahead hits since.
+ */
+#define SWAP_RA_WIN_SHIFT	(PAGE_SHIFT / 2)
+#define SWAP_RA_HITS_MASK	((1UL << SWAP_RA_WIN_SHIFT) - 1)
+#define SWAP_RA_HITS_MAX	SWAP_RA_HITS_MASK
+#define SWAP_RA_WIN_MASK	(~PAGE_MASK & ~SWAP_RA_HITS_MASK)
+
+#define SWAP_RA_HITS(v)		((v) & SWAP_RA_HITS_MASK)
+#define SWAP_RA_WIN(v)		(((v) & SWAP_RA_WIN_MASK) >> SWAP_RA_WIN_SHIFT)
+#define SWAP_RA_ADDR(v)		((v) & PAGE_MASK)
+
+#define SWAP_RA_VAL(addr, win, hits)				\
+	(((addr) & PAGE_MASK) |					\
+	 (((win) << SWAP_RA_WIN_SHIFT) & SWAP_RA_WIN_MASK) |	\
+	 ((hits) & SWAP_RA_HITS_MASK))
+
+/* Page table entries swap_vma_readahead() copies at most */
+#define SWAP_RA_PTES_MAX	32
+
+bool swap_vma_readahead_enabled __read_mostly = true;
+
 /*
  * Lookup a swap entry in the swap cache. A found page will be returned
  * unlocked and with its refcount incremented - we rely on the kernel
  * lock getting page table operations atomic even if we drop the page
  * lock before returning.
+ *
+ * A page that was read ahead counts as a readahead hit, for @vma if one
+ * is given.
  */
-struct page * lookup_swap_cache(swp_entry_t entry)
+struct page *lookup_swap_cache(swp_entry_t entry,
+			       struct vm_area_struct *vma, unsigned long addr)
 {
 	struct page *page;
 
 	page = find_get_page(&swapper_space, entry.val);
 
-	if (page)
+	if (page) {
 		INC_CACHE_INFO(find_success);
+		if (TestClearPageReadahead(page)) {
+			count_vm_event(SWAP_RA_HIT);
+			if (vma) {
+				unsigned long ra_val, hits;
+
+				ra_val = atomic_long_read(
+						&vma->swap_readahead_info);
+				hits = min(SWAP_RA_HITS(ra_val) + 1,
+					   SWAP_RA_HITS_MAX);
+				atomic_long_set(&vma->swap_readahead_info,
+					SWAP_RA_VAL(addr, SWAP_RA_WIN(ra_val),
+						    hits));
+			}
+		}
+	}
 
 	INC_CACHE_INFO(find_total);
 	return page;
 }
 
-/* 
+/*
  * Locate a page of swap in physical memory, reserving swap cache space
- * and reading the disk if it is not already cached.
- * A failure return means that either the page allocation failed or that
- * the swap entry is no longer in use.
+ * and reading the disk if it is not already cached.  A page that has to
+ * be read for @readahead is marked, so a later lookup_swap_cache() can
+ * tell whether reading it was worth it.
  */
-struct page *read_swap_cache_async(swp_entry_t entry, gfp_t gfp_mask,
-			struct vm_area_struct *vma, unsigned long addr)
+static struct page *__read_swap_cache_async(swp_entry_t entry,
+			gfp_t gfp_mask, struct vm_area_struct *vma,
+			unsigned long addr, bool readahead)
 {
 	struct page *found_page, *new_page = NULL;
 	int err;
@@ -351,6 +397,10 @@ struct page *read_swap_cache_async(swp_entry_t entry, gfp_t gfp_mask,
 			 * Initiate read into locked page and return.
 			 */
 			lru_cache_add_anon(new_page);
+			if (readahead) {
+				SetPageReadahead(new_page);
+				count_vm_event(SWAP_RA);
+			}
 			swap_readpage(new_page);
 			return new_page;
 		}
@@ -369,6 +419,18 @@ struct page *read_swap_cache_async(swp_entry_t entry, gfp_t gfp_mask,
 	return found_page;
 }
 
+/* 
+ * Locate a page of swap in physical memory, reserving swap cache space
+ * and reading the disk if it is not already cached.
+ * A failure return means that either the page allocation failed or that
+ * the swap entry is no longer in use.
+ */
+struct page *read_swap_cache_async(swp_entry_t entry, gfp_t gfp_mask,
+			struct vm_area_struct *vma, unsigned long addr)
+{
+	return __read_swap_cache_async(entry, gfp_mask, vma, addr, false);
+}
+
 /**
  * swapin_readahead - swap in pages in hope we need them soon
  * @entry: swap entry of this memory
@@ -406,8 +468,9 @@ struct page *swapin_readahead(swp_entry_t entry, gfp_t gfp_mask,
 	blk_start_plug(&plug);
 	for (offset = start_offset; offset <= end_offset ; offset++) {
 		/* Ok, do the async read-ahead now */
-		page = read_swap_cache_async(swp_entry(swp_type(entry), offset),
-						gfp_mask, vma, addr);
+		page = __read_swap_cache_async(
+				swp_entry(swp_type(entry), offset),
+				gfp_mask, vma, addr, offset != swp_offset(entry));
 		if (!page)
 			continue;
 		page_cache_release(page);
@@ -417,3 +480,170 @@ struct page *swapin_readahead(swp_entry_t entry, gfp_t gfp_mask,
 	lru_add_drain();	/* Push any new pages onto the LRU now */
 	return read_swap_cache_async(entry, gfp_mask, vma, addr);
 }
+
+/*
+ * Size the next readahead window of a vma from the hits of the last one:
+ * grow it to the next power of two above the hits, but never to more
+ * than @max_win, and shrink it by at most half a step.  Without any
+ * hits, only read ahead if the fault is next to the previous one.
+ */
+static unsigned int swap_ra_window(unsigned long prev_pfn, unsigned long pfn,
+				   unsigned int hits, unsigned int prev_win,
+				   unsigned int max_win)
+{
+	unsigned int win = hits + 2;
+
+	if (!hits) {
+		if (pfn != prev_pfn + 1 && pfn != prev_pfn - 1)
+			win = 1;
+	} else {
+		win = roundup_pow_of_two(max(win, 4U));
+	}
+
+	if (win > max_win)
+		win = max_win;
+	if (win < prev_win / 2)
+		win = prev_win / 2;
+	return win;
+}
+
+/**
+ * swap_vma_readahead - swap in pages in hope we need them soon
+ * @fentry: swap entry of the faulting address
+ * @gfp_mask: memory allocation flags
+ * @vma: user vma the faulting address belongs to
+ * @faddr: faulting address
+ * @pmd: pmd covering @faddr
+ *
+ * Returns the struct page for @fentry and @faddr, after queueing swapin.
+ *
+ * Unlike swapin_readahead(), which reads the swap slots next to @fentry,
+ * this reads the swap entries of the ptes next to @faddr: on devices
+ * like zram, slots that are neighbours on swap rarely belong together,
+ * while neighbouring pages of a vma often do.  The window is sized from
+ * the hits the vma had on its last one, and grows towards the direction
+ * the faults move in, up to 1 << page_cluster pages within @vma and the
+ * page table of @faddr.
+ *
+ * Caller must hold down_read on the vma->vm_mm.
+ */
+struct page *swap_vma_readahead(swp_entry_t fentry, gfp_t gfp_mask,
+				struct vm_area_struct *vma, unsigned long faddr,
+				pmd_t *pmd)
+{
+	unsigned long ra_val, fpfn, pfn, start, end, lo, hi, addr;
+	unsigned int max_win, win, i, nr;
+	pte_t ptes[SWAP_RA_PTES_MAX], *pte;
+	struct blk_plug plug;
+	struct page *page;
+	swp_entry_t entry;
+
+	max_win = min_t(unsigned int, 1U << page_cluster, SWAP_RA_PTES_MAX);
+	if (max_win == 1)
+		goto out;
+
+	faddr &= PAGE_MASK;
+	fpfn = faddr >> PAGE_SHIFT;
+	ra_val = atomic_long_read(&vma->swap_readahead_info);
+	pfn = SWAP_RA_ADDR(ra_val) >> PAGE_SHIFT;
+	win = swap_ra_window(pfn, fpfn, SWAP_RA_HITS(ra_val),
+			     SWAP_RA_WIN(ra_val), max_win);
+	atomic_long_set(&vma->swap_readahead_info,
+			SWAP_RA_VAL(faddr, win, 0));
+	if (win == 1)
+		goto out;
+
+	/* Read forward or backward if the faults do, else around faddr */
+	if (fpfn == pfn + 1) {
+		start = fpfn;
+	} else if (pfn == fpfn + 1) {
+		start = fpfn + 1 - win;
+	} else {
+		start = fpfn - (win - 1) / 2;
+	}
+	end = start + win;
+
+	lo = max(vma->vm_start, faddr & PMD_MASK) >> PAGE_SHIFT;
+	hi = min(vma->vm_end, (faddr & PMD_MASK) + PMD_SIZE) >> PAGE_SHIFT;
+	if (start < lo || start > fpfn)
+		start = lo;
+	if (end > hi)
+		end = hi;
+	nr = end - start;
+
+	/* Copy the ptes: read_swap_cache_async() cannot run under kmap */
+	pte = pte_offset_map(pmd, start << PAGE_SHIFT);
+	for (i = 0; i < nr; i++)
+		ptes[i] = pte[i];
+	pte_unmap(pte);
+
+	blk_start_plug(&plug);
+	for (i = 0, addr = start << PAGE_SHIFT; i < nr;
+	     i++, addr += PAGE_SIZE) {
+		if (addr == faddr)
+			continue;
+		if (pte_none(ptes[i]) || pte_present(ptes[i]) ||
+		    pte_file(ptes[i]))
+			continue;
+		entry = pte_to_swp_entry(ptes[i]);
+		if (unlikely(non_swap_entry(entry)))
+			continue;
+		page = __read_swap_cache_async(entry, gfp_mask, vma, addr,
+					       true);
+		if (!page)
+			continue;
+		page_cache_release(page);
+	}
+	blk_finish_plug(&plug);
+
+	lru_add_drain();	/* Push any new pages onto the LRU now */
+out:
+	return read_swap_cache_async(fentry, gfp_mask, vma, faddr);
+}
+
+#ifdef CONFIG_SYSFS
+static ssize_t vma_ra_enabled_show(struct kobject *kobj,
+				   struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%s\n",
+		       swap_vma_readahead_enabled ? "true" : "false");
+}
+
+static ssize_t vma_ra_enabled_store(struct kobject *kobj,
+				    struct kobj_attribute *attr,
+				    const char *buf, size_t count)
+{
+	if (sysfs_streq(buf, "true") || sysfs_streq(buf, "1"))
+		swap_vma_readahead_enabled = true;
+	else if (sysfs_streq(buf, "false") || sysfs_streq(buf, "0"))
+		swap_vma_readahead_enabled = false;
+	else
+		return -EINVAL;
+
+	return count;
+}
+static struct kobj_attribute vma_ra_enabled_attr =
+	__ATTR(vma_ra_enabled, 0644, vma_ra_enabled_show,
+	       vma_ra_enabled_store);
+
+static struct attribute *swap_attrs[] = {
+	&vma_ra_enabled_attr.attr,
+	NULL,
+};
+
+static struct attribute_group swap_attr_group = {
+	.attrs = swap_attrs,
+	.name = "swap",
+};
+
+static int __init swap_init_sysfs(void)
+{
+	int err;
+
+	err = sysfs_create_group(mm_kobj, &swap_attr_group);
+	if (err)
+		printk(KERN_ERR "swap: register sysfs failed\n");
+	return err;
+}
+__initcall(swap_init_sysfs);
+#endif /* CONFIG_SYSFS */
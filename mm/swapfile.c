@@ -409,17 +409,25 @@ no_page:
 	return 0;
 }
 
-swp_entry_t get_swap_page(void)
+/*
+ * Allocate up to @n swap entries for the swap cache into @slots, taking
+ * swap_lock once for the whole batch.  Consecutive entries come out of
+ * the same SWAPFILE_CLUSTER run of scan_swap_map(), so a batch is
+ * normally one contiguous range of slots.  Returns the number allocated.
+ */
+static int get_swap_pages(int n, swp_entry_t slots[])
 {
 	struct swap_info_struct *si;
 	pgoff_t offset;
 	int type, next;
 	int wrapped = 0;
+	int n_ret = 0;
 
 	spin_lock(&swap_lock);
 	if (nr_swap_pages <= 0)
 		goto noswap;
-	nr_swap_pages--;
+	n = min_t(long, n, nr_swap_pages);
+	nr_swap_pages -= n;
 
 	for (type = swap_list.next; type >= 0 && wrapped < 2; type = next) {
 		si = swap_info[type];
@@ -437,18 +445,87 @@ swp_entry_t get_swap_page(void)
 
 		swap_list.next = next;
 		/* This is called for allocating swap entry for cache */
-		offset = scan_swap_map(si, SWAP_HAS_CACHE);
-		if (offset) {
-			spin_unlock(&swap_lock);
-			return swp_entry(type, offset);
+		while (n_ret < n) {
+			offset = scan_swap_map(si, SWAP_HAS_CACHE);
+			if (!offset)
+				break;
+			slots[n_ret++] = swp_entry(type, offset);
 		}
+		if (n_ret == n)
+			break;
 		next = swap_list.next;
 	}
 
-	nr_swap_pages++;
+	nr_swap_pages += n - n_ret;
 noswap:
 	spin_unlock(&swap_lock);
-	return (swp_entry_t) {0};
+	return n_ret;
+}
+
+/*
+ * Per-cpu swap slot caches.
+ *
+ * Allocating or freeing a swap slot takes the global swap_lock, and
+ * reclaim swapping out a large anonymous workload does little else.
+ * Each cpu therefore keeps a batch of slots allocated by one call to
+ * get_swap_pages(), and collects the slots freed from the swap cache
+ * to return them to the swap_map under one swap_lock hold.  Taking the
+ * slots in batches also keeps each cpu's swap-outs contiguous on the
+ * device, instead of interleaving them with the other cpus'.
+ *
+ * A cached slot is marked SWAP_HAS_CACHE in the swap_map with no swap
+ * cache page behind it; swapcache_prepare() fails on such a slot with
+ * -ENOENT, so swapin readahead does not wait for it.  swapoff disables
+ * the caches and drains them before it looks for slots in use.
+ */
+#define SWAP_SLOTS_CACHE_SIZE	64
+
+struct swap_slots_cache {
+	struct mutex	alloc_lock;	/* protects slots, cur and nr */
+	swp_entry_t	slots[SWAP_SLOTS_CACHE_SIZE];
+	int		cur;		/* next slot to hand out */
+	int		nr;		/* slots left from cur */
+	spinlock_t	free_lock;	/* protects slots_ret and n_ret */
+	swp_entry_t	slots_ret[SWAP_SLOTS_CACHE_SIZE];
+	int		n_ret;
+};
+
+static DEFINE_PER_CPU(struct swap_slots_cache, swap_slots);
+
+/* Number of swapoffs in progress; protected by swap_lock */
+static int swap_slots_cache_disabled;
+
+/*
+ * Only refill the caches while there is plenty of swap left, so that
+ * slots parked on one cpu do not make another one fail to swap out.
+ */
+static inline bool swap_slots_cache_active(void)
+{
+	return !swap_slots_cache_disabled &&
+		nr_swap_pages > 2 * SWAP_SLOTS_CACHE_SIZE * num_online_cpus();
+}
+
+swp_entry_t get_swap_page(void)
+{
+	struct swap_slots_cache *cache;
+	swp_entry_t entry = { 0 };
+
+	cache = &per_cpu(swap_slots, raw_smp_processor_id());
+
+	mutex_lock(&cache->alloc_lock);
+	if (!cache->nr && swap_slots_cache_active()) {
+		cache->cur = 0;
+		cache->nr = get_swap_pages(SWAP_SLOTS_CACHE_SIZE, cache->slots);
+	}
+	if (cache->nr) {
+		entry = cache->slots[cache->cur++];
+		cache->nr--;
+	}
+	mutex_unlock(&cache->alloc_lock);
+
+	if (!entry.val)
+		get_swap_pages(1, &entry);
+	return entry;
 }
 
 /* The only caller of this function is now susupend routine */
@@ -473,7 +550,7 @@ swp_entry_t get_swap_page_of_type(int type)
 	return (swp_entry_t) {0};
 }
 
-static struct swap_info_struct *swap_info_get(swp_entry_t entry)
+static struct swap_info_struct *__swap_info_get(swp_entry_t entry)
 {
 	struct swap_info_struct *p;
 	unsigned long offset, type;
@@ -491,7 +568,6 @@ static struct swap_info_struct *swap_info_get(swp_entry_t entry)
 		goto bad_offset;
 	if (!p->swap_map[offset])
 		goto bad_free;
-	spin_lock(&swap_lock);
 	return p;
 
 bad_free:
@@ -509,6 +585,16 @@ out:
 	return NULL;
 }
 
+static struct swap_info_struct *swap_info_get(swp_entry_t entry)
+{
+	struct swap_info_struct *p;
+
+	p = __swap_info_get(entry);
+	if (p)
+		spin_lock(&swap_lock);
+	return p;
+}
+
 static unsigned char swap_entry_free(struct swap_info_struct *p,
 				     swp_entry_t entry, unsigned char usage)
 {
@@ -565,6 +651,98 @@ static unsigned char swap_entry_free(struct swap_info_struct *p,
 	return usage;
 }
 
+/*
+ * Drop the swap cache reference to @n slots that have no other users,
+ * under one swap_lock hold.
+ */
+static void swapcache_free_entries(swp_entry_t *entries, int n)
+{
+	int i;
+
+	if (!n)
+		return;
+
+	spin_lock(&swap_lock);
+	for (i = 0; i < n; i++)
+		swap_entry_free(swap_info[swp_type(entries[i])], entries[i],
+				SWAP_HAS_CACHE);
+	spin_unlock(&swap_lock);
+}
+
+/*
+ * Queue a slot whose only remaining reference is SWAP_HAS_CACHE to be
+ * freed with the next batch.  Returns false if the caches are disabled
+ * and the caller has to free the slot itself.
+ */
+static bool free_swap_slot(swp_entry_t entry)
+{
+	struct swap_slots_cache *cache = &get_cpu_var(swap_slots);
+	bool queued = false;
+
+	spin_lock(&cache->free_lock);
+	if (!swap_slots_cache_disabled) {
+		if (cache->n_ret == SWAP_SLOTS_CACHE_SIZE) {
+			swapcache_free_entries(cache->slots_ret, cache->n_ret);
+			cache->n_ret = 0;
+		}
+		cache->slots_ret[cache->n_ret++] = entry;
+		queued = true;
+	}
+	spin_unlock(&cache->free_lock);
+	put_cpu_var(swap_slots);
+
+	return queued;
+}
+
+static void drain_swap_slots_cpu(unsigned int cpu)
+{
+	struct swap_slots_cache *cache = &per_cpu(swap_slots, cpu);
+
+	mutex_lock(&cache->alloc_lock);
+	swapcache_free_entries(cache->slots + cache->cur, cache->nr);
+	cache->cur = 0;
+	cache->nr = 0;
+	mutex_unlock(&cache->alloc_lock);
+
+	spin_lock(&cache->free_lock);
+	swapcache_free_entries(cache->slots_ret, cache->n_ret);
+	cache->n_ret = 0;
+	spin_unlock(&cache->free_lock);
+}
+
+static void drain_swap_slots(void)
+{
+	unsigned int cpu;
+
+	get_online_cpus();
+	for_each_online_cpu(cpu)
+		drain_swap_slots_cpu(cpu);
+	put_online_cpus();
+}
+
+static int swap_slots_cpu_notify(struct notifier_block *self,
+				 unsigned long action, void *hcpu)
+{
+	if (action == CPU_DEAD || action == CPU_DEAD_FROZEN)
+		drain_swap_slots_cpu((unsigned long)hcpu);
+	return NOTIFY_OK;
+}
+
+static int __init swap_slots_init(void)
+{
+	unsigned int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct swap_slots_cache *cache = &per_cpu(swap_slots, cpu);
+
+		mutex_init(&cache->alloc_lock);
+		spin_lock_init(&cache->free_lock);
+	}
+	hotcpu_notifier(swap_slots_cpu_notify, 0);
+	return 0;
+}
+__initcall(swap_slots_init);
+
 /*
  * Caller has made sure that the swapdevice corresponding to entry
  * is still around or has not been recycled.
@@ -588,13 +766,27 @@ void swapcache_free(swp_entry_t entry, struct page *page)
 	struct swap_info_struct *p;
 	unsigned char count;
 
-	p = swap_info_get(entry);
-	if (p) {
-		count = swap_entry_free(p, entry, SWAP_HAS_CACHE);
+	p = __swap_info_get(entry);
+	if (!p)
+		return;
+
+	/*
+	 * Only the swap cache can take a new reference to a slot that
+	 * has no other users, and we are dropping that one: nobody else
+	 * can change the swap_map entry under us.
+	 */
+	if (ACCESS_ONCE(p->swap_map[swp_offset(entry)]) == SWAP_HAS_CACHE &&
+	    free_swap_slot(entry)) {
 		if (page)
-			mem_cgroup_uncharge_swapcache(page, entry, count != 0);
-		spin_unlock(&swap_lock);
+			mem_cgroup_uncharge_swapcache(page, entry, false);
+		return;
 	}
+
+	spin_lock(&swap_lock);
+	count = swap_entry_free(p, entry, SWAP_HAS_CACHE);
+	if (page)
+		mem_cgroup_uncharge_swapcache(page, entry, count != 0);
+	spin_unlock(&swap_lock);
 }
 
 /*
@@ -1610,12 +1802,20 @@ SYSCALL_DEFINE1(swapoff, const char __user *, specialfile)
 	nr_swap_pages -= p->pages;
 	total_swap_pages -= p->pages;
 	p->flags &= ~SWP_WRITEOK;
+	swap_slots_cache_disabled++;
 	spin_unlock(&swap_lock);
 
+	/* try_to_unuse() would wait forever on slots parked in the caches */
+	drain_swap_slots();
+
 	oom_score_adj = test_set_oom_score_adj(OOM_SCORE_ADJ_MAX);
 	err = try_to_unuse(type);
 	compare_swap_oom_score_adj(OOM_SCORE_ADJ_MAX, oom_score_adj);
 
+	spin_lock(&swap_lock);
+	swap_slots_cache_disabled--;
+	spin_unlock(&swap_lock);
+
 	if (err) {
 		/*
 		 * reading p->prio and p->swap_map outside the lock is
@@ -2235,8 +2435,10 @@ static int __swap_duplicate(swp_entry_t entry, unsigned char usage)
 		/* set SWAP_HAS_CACHE if there is no cache and entry is used */
 		if (!has_cache && count)
 			has_cache = SWAP_HAS_CACHE;
-		else if (has_cache)		/* someone else added cache */
-			err = -EEXIST;
+		else if (has_cache && (count || swap_slots_cache_disabled))
+			err = -EEXIST;		/* someone else added cache */
+		else if (has_cache)		/* parked in a slot cache */
+			err = -ENOENT;
 		else				/* no users remaining */
 			err = -ENOENT;
 
@@ -183,6 +183,52 @@ int invalidate_inode_page(struct page *page)
 	return invalidate_complete_page(mapping, page);
 }
 
+/**
+ * clear_shadow_entries - remove the shadow entries of evicted pages
+ * @mapping: mapping to clear
+ * @start: first page index
+ * @end: last page index, inclusive
+ *
+ * Shadow entries (see mm/workingset.c) hold radix tree nodes, so they
+ * have to go when the file is truncated and before the inode is freed.
+ */
+void clear_shadow_entries(struct address_space *mapping,
+			  pgoff_t start, pgoff_t end)
+{
+	struct radix_tree_iter iter;
+	pgoff_t indices[PAGEVEC_SIZE];
+	void **slot;
+	int i, nr;
+
+	while (mapping->nrshadows) {
+		nr = 0;
+		spin_lock_irq(&mapping->tree_lock);
+		radix_tree_for_each_slot(slot, &mapping->page_tree,
+					 &iter, start) {
+			void *entry;
+
+			if (iter.index > end)
+				break;
+			entry = radix_tree_deref_slot_protected(slot,
+							&mapping->tree_lock);
+			if (!radix_tree_exceptional_entry(entry))
+				continue;
+			indices[nr] = iter.index;
+			if (++nr == PAGEVEC_SIZE)
+				break;
+		}
+		for (i = 0; i < nr; i++)
+			radix_tree_delete(&mapping->page_tree, indices[i]);
+		mapping->nrshadows -= nr;
+		spin_unlock_irq(&mapping->tree_lock);
+
+		if (nr < PAGEVEC_SIZE || indices[nr - 1] >= end)
+			break;
+		start = indices[nr - 1] + 1;
+		cond_resched();
+	}
+}
+
 /**
  * truncate_inode_pages - truncate range of pages specified by start & end byte offsets
  * @mapping: mapping to truncate
@@ -214,7 +260,7 @@ void truncate_inode_pages_range(struct address_space *mapping,
 	int i;
 
 	cleancache_flush_inode(mapping);
-	if (mapping->nrpages == 0)
+	if (mapping->nrpages == 0 && mapping->nrshadows == 0)
 		return;
 
 	BUG_ON((lend & (PAGE_CACHE_SIZE - 1)) != (PAGE_CACHE_SIZE - 1));
@@ -292,6 +338,7 @@ void truncate_inode_pages_range(struct address_space *mapping,
 		mem_cgroup_uncharge_end();
 		index++;
 	}
+	clear_shadow_entries(mapping, start, end);
 	cleancache_flush_inode(mapping);
 }
 EXPORT_SYMBOL(truncate_inode_pages_range);
@@ -393,7 +440,7 @@ invalidate_complete_page2(struct address_space *mapping, struct page *page)
 		goto failed;
 
 	BUG_ON(page_has_private(page));
-	__delete_from_page_cache(page);
+	__delete_from_page_cache(page, NULL);
 	spin_unlock_irq(&mapping->tree_lock);
 	mem_cgroup_uncharge_cache_page(page);
 
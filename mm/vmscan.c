@@ -44,6 +44,8 @@
 #include <linux/sysctl.h>
 #include <linux/oom.h>
 #include <linux/prefetch.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 
 #include <asm/tlbflush.h>
 #include <asm/div64.h>
@@ -526,8 +528,12 @@ static pageout_t pageout(struct page *page, struct address_space *mapping,
 /*
  * Same as remove_mapping, but if the page is removed from the mapping, it
  * gets returned with a refcount of 0.
+ *
+ * @reclaimed tells that the page is evicted by reclaim, rather than
+ * invalidated: its eviction is recorded for refault detection.
  */
-static int __remove_mapping(struct address_space *mapping, struct page *page)
+static int __remove_mapping(struct address_space *mapping, struct page *page,
+			    bool reclaimed)
 {
 	BUG_ON(!PageLocked(page));
 	BUG_ON(mapping != page_mapping(page));
@@ -573,10 +579,13 @@ static int __remove_mapping(struct address_space *mapping, struct page *page)
 		swapcache_free(swap, page);
 	} else {
 		void (*freepage)(struct page *);
+		void *shadow = NULL;
 
 		freepage = mapping->a_ops->freepage;
 
-		__delete_from_page_cache(page);
+		if (reclaimed && page_is_file_cache(page))
+			shadow = workingset_eviction(mapping, page);
+		__delete_from_page_cache(page, shadow);
 		spin_unlock_irq(&mapping->tree_lock);
 		mem_cgroup_uncharge_cache_page(page);
 
@@ -599,7 +608,7 @@ cannot_free:
  */
 int remove_mapping(struct address_space *mapping, struct page *page)
 {
-	if (__remove_mapping(mapping, page)) {
+	if (__remove_mapping(mapping, page, false)) {
 		/*
 		 * Unfreezing the refcount with 1 rather than 2 effectively
 		 * drops the pagecache ref for us without requiring another
@@ -957,7 +966,7 @@ static unsigned long shrink_page_list(struct list_head *page_list,
 			}
 		}
 
-		if (!mapping || !__remove_mapping(mapping, page))
+		if (!mapping || !__remove_mapping(mapping, page, true))
 			goto keep_locked;
 
 		/*
@@ -1213,6 +1222,10 @@ static unsigned long isolate_lru_pages(unsigned long nr_to_scan,
 			    !PageSwapCache(cursor_page))
 				break;
 
+			/* Left over from the multi-gen LRU, being drained */
+			if (page_lru_gen(cursor_page) >= 0)
+				break;
+
 			if (__isolate_lru_page(cursor_page, mode, file) == 0) {
 				list_move(&cursor_page->lru, dst);
 				mem_cgroup_del_lru(cursor_page);
@@ -1618,8 +1631,12 @@ static void move_active_pages_to_lru(struct zone *zone,
 		VM_BUG_ON(PageLRU(page));
 		SetPageLRU(page);
 
-		list_move(&page->lru, &zone->lru[lru].list);
-		mem_cgroup_add_lru_list(page, lru);
+		/*
+		 * Goes to the multi-gen LRU instead if it was switched on
+		 * while these pages were isolated.
+		 */
+		list_del(&page->lru);
+		add_page_to_lru_list(zone, page, lru);
 		pgmoved += hpage_nr_pages(page);
 
 		if (!pagevec_add(&pvec, page) || list_empty(list)) {
@@ -1630,7 +1647,6 @@ static void move_active_pages_to_lru(struct zone *zone,
 			spin_lock_irq(&zone->lru_lock);
 		}
 	}
-	__mod_zone_page_state(zone, NR_LRU_BASE + lru, pgmoved);
 	if (!is_active_lru(lru))
 		__count_vm_events(PGDEACTIVATE, pgmoved);
 }
@@ -1771,6 +1787,10 @@ static int inactive_anon_is_low(struct zone *zone, struct scan_control *sc)
 	if (!total_swap_pages)
 		return 0;
 
+	/* The multi-gen LRU has no active list to deactivate from. */
+	if (lru_gen_enabled())
+		return 0;
+
 	if (scanning_global_lru(sc))
 		low = inactive_anon_is_low_global(zone);
 	else
@@ -2042,6 +2062,738 @@ static inline bool should_continue_reclaim(struct zone *zone,
 	}
 }
 
+#ifdef CONFIG_LRU_GEN
+/*
+ * Multi-gen LRU
+ *
+ * Two lists per type cannot tell a page that was used a second ago from
+ * one that was used a minute ago, and the active list is only rotated
+ * through rmap, which costs a walk of every mapping of every page taken
+ * off it.  The multi-gen LRU instead keeps up to MAX_NR_GENS generations
+ * of pages per type and zone.  Aging starts a new, youngest generation,
+ * max_seq, and kswapd fills it by walking the page tables of every mm:
+ * a pte that was accessed since the last walk moves its page there, so
+ * each accessed pte is found by a sequential scan rather than by rmap.
+ * Eviction takes pages from the tail of the oldest generation, min_seq,
+ * of the type chosen by swappiness, and shrink_page_list() still checks
+ * the references of each page it is given, as it does for the inactive
+ * list.
+ *
+ * The two youngest generations are accounted as active in the vmstat
+ * counters and the rest as inactive, so that the watermark and
+ * writeback throttling heuristics see the numbers they expect.  Pages
+ * are only ever moved between lists under zone->lru_lock, and the
+ * generation in page->flags always names the list the page is on.
+ */
+
+/* how many pages to move under zone->lru_lock before dropping it */
+#define LRU_GEN_BATCH		SWAP_CLUSTER_MAX
+
+#ifdef CONFIG_LRU_GEN_ENABLED
+unsigned int lru_gen_state __read_mostly = LRU_GEN_CORE | LRU_GEN_MM_WALK;
+#else
+unsigned int lru_gen_state __read_mostly;
+#endif
+
+/* serializes changes of lru_gen_state, and the page table walks */
+static DEFINE_MUTEX(lru_gen_mutex);
+
+/* every mm that can be walked, protected by lru_gen_mm_lock */
+static LIST_HEAD(lru_gen_mm_list);
+static DEFINE_SPINLOCK(lru_gen_mm_lock);
+static unsigned long lru_gen_nr_mms;
+
+/*
+ * Only an mm that is fully set up and owned by a task is added, so that
+ * the last mmput() is what takes it off again.  __mmdrop() checks once
+ * more, for an mm that was never used.
+ */
+void lru_gen_add_mm(struct mm_struct *mm)
+{
+	spin_lock(&lru_gen_mm_lock);
+	VM_BUG_ON(!list_empty(&mm->lru_gen_list));
+	list_add_tail(&mm->lru_gen_list, &lru_gen_mm_list);
+	lru_gen_nr_mms++;
+	spin_unlock(&lru_gen_mm_lock);
+}
+
+void lru_gen_del_mm(struct mm_struct *mm)
+{
+	spin_lock(&lru_gen_mm_lock);
+	if (!list_empty(&mm->lru_gen_list)) {
+		list_del_init(&mm->lru_gen_list);
+		lru_gen_nr_mms--;
+	}
+	spin_unlock(&lru_gen_mm_lock);
+}
+
+void lru_gen_init_zone(struct zone *zone)
+{
+	struct lru_gen_struct *lrugen = &zone->lrugen;
+	int gen, type;
+
+	memset(lrugen, 0, sizeof(*lrugen));
+	lrugen->max_seq = MIN_NR_GENS + 1;
+	for (gen = 0; gen < MAX_NR_GENS; gen++) {
+		lrugen->timestamps[gen] = jiffies;
+		for (type = 0; type < ANON_AND_FILE; type++)
+			INIT_LIST_HEAD(&lrugen->lists[gen][type]);
+	}
+}
+
+static int lru_gen_walk_pmd(pmd_t *pmd, unsigned long addr,
+			    unsigned long end, struct mm_walk *walk)
+{
+	struct vm_area_struct *vma = walk->private;
+	pte_t *pte, ptent;
+	spinlock_t *ptl;
+	struct page *page;
+	int gen;
+
+	split_huge_page_pmd(walk->mm, pmd);
+	if (pmd_trans_unstable(pmd))
+		return 0;
+
+	pte = pte_offset_map_lock(vma->vm_mm, pmd, addr, &ptl);
+	for (; addr != end; pte++, addr += PAGE_SIZE) {
+		ptent = *pte;
+		if (!pte_present(ptent) || !pte_young(ptent))
+			continue;
+
+		page = vm_normal_page(vma, addr, ptent);
+		if (!page || PageReserved(page))
+			continue;
+
+		ptep_test_and_clear_young(vma, addr, pte);
+
+		/* activate_page() puts it in the youngest generation */
+		gen = page_lru_gen(page);
+		if (gen >= 0 &&
+		    gen != lru_gen_from_seq(page_zone(page)->lrugen.max_seq))
+			activate_page(page);
+	}
+	pte_unmap_unlock(pte - 1, ptl);
+	cond_resched();
+	return 0;
+}
+
+static void lru_gen_walk_mm(struct mm_struct *mm)
+{
+	struct vm_area_struct *vma;
+	struct mm_walk walk = {
+		.pmd_entry = lru_gen_walk_pmd,
+		.mm = mm,
+	};
+
+	if (!down_read_trylock(&mm->mmap_sem))
+		return;
+
+	for (vma = mm->mmap; vma; vma = vma->vm_next) {
+		/* no LRU pages, or they are not going to be reclaimed */
+		if (vma->vm_flags & (VM_IO | VM_PFNMAP | VM_HUGETLB |
+				     VM_LOCKED))
+			continue;
+		/* readahead already ages these as they are accessed */
+		if (vma->vm_flags & VM_SEQ_READ)
+			continue;
+
+		walk.private = vma;
+		walk_page_range(vma->vm_start, vma->vm_end, &walk);
+	}
+	flush_tlb_mm(mm);
+	up_read(&mm->mmap_sem);
+}
+
+/*
+ * Walk every mm once, rotating lru_gen_mm_list so that mms added while
+ * the walk sleeps are seen the next time round.
+ */
+static void lru_gen_walk_mms(void)
+{
+	struct mm_struct *mm, *prev = NULL;
+	unsigned long nr;
+
+	spin_lock(&lru_gen_mm_lock);
+	for (nr = lru_gen_nr_mms; nr && !list_empty(&lru_gen_mm_list); nr--) {
+		mm = list_first_entry(&lru_gen_mm_list, struct mm_struct,
+				      lru_gen_list);
+		list_move_tail(&mm->lru_gen_list, &lru_gen_mm_list);
+		if (!atomic_inc_not_zero(&mm->mm_users))
+			continue;
+		spin_unlock(&lru_gen_mm_lock);
+
+		/* mmput() takes lru_gen_mm_lock for the last reference */
+		if (prev)
+			mmput(prev);
+		lru_gen_walk_mm(mm);
+		prev = mm;
+
+		spin_lock(&lru_gen_mm_lock);
+	}
+	spin_unlock(&lru_gen_mm_lock);
+
+	if (prev)
+		mmput(prev);
+
+	/* the pages activated by the walk are still on the pagevecs */
+	lru_add_drain();
+}
+
+/*
+ * Move up to LRU_GEN_BATCH pages of @type from the oldest generation to
+ * the next one, and retire the oldest generation once it is empty.
+ * Returns true if it was retired.
+ */
+static bool inc_min_seq(struct zone *zone, int type)
+{
+	struct lru_gen_struct *lrugen = &zone->lrugen;
+	int old_gen = lru_gen_from_seq(lrugen->min_seq[type]);
+	int new_gen = lru_gen_from_seq(lrugen->min_seq[type] + 1);
+	struct list_head *head = &lrugen->lists[old_gen][type];
+	int batch = 0;
+
+	/* from the head, so that the oldest pages stay at the tail */
+	while (!list_empty(head)) {
+		struct page *page = list_first_entry(head, struct page, lru);
+
+		if (batch++ == LRU_GEN_BATCH)
+			return false;
+
+		VM_BUG_ON(page_lru_gen(page) != old_gen);
+		lru_gen_update_size(zone, page, old_gen, new_gen);
+		set_page_lru_gen(page, new_gen);
+		list_move_tail(&page->lru, &lrugen->lists[new_gen][type]);
+	}
+
+	lrugen->min_seq[type]++;
+	return true;
+}
+
+static bool lru_gen_need_aging(struct zone *zone, bool can_swap)
+{
+	struct lru_gen_struct *lrugen = &zone->lrugen;
+
+	if (lrugen->min_seq[LRU_GEN_FILE] + MIN_NR_GENS > lrugen->max_seq)
+		return true;
+
+	return can_swap &&
+	       lrugen->min_seq[LRU_GEN_ANON] + MIN_NR_GENS > lrugen->max_seq;
+}
+
+/* Start a new generation in @zone. */
+static void inc_max_seq(struct zone *zone, bool can_swap)
+{
+	struct lru_gen_struct *lrugen = &zone->lrugen;
+	int type, gen;
+	long delta;
+
+	spin_lock_irq(&zone->lru_lock);
+
+	/* someone else got here first */
+	if (!lru_gen_need_aging(zone, can_swap))
+		goto out;
+
+	/* make room for the new generation */
+	for (type = 0; type < ANON_AND_FILE; type++) {
+		while (lrugen->max_seq - lrugen->min_seq[type] + 2 >
+		       MAX_NR_GENS) {
+			if (inc_min_seq(zone, type))
+				continue;
+			spin_unlock_irq(&zone->lru_lock);
+			cond_resched();
+			spin_lock_irq(&zone->lru_lock);
+		}
+	}
+
+	/* the second youngest generation stops being active */
+	gen = lru_gen_from_seq(lrugen->max_seq - 1);
+	for (type = 0; type < ANON_AND_FILE; type++) {
+		enum lru_list l = type ? LRU_INACTIVE_FILE : LRU_INACTIVE_ANON;
+
+		delta = lrugen->nr_pages[gen][type];
+		__mod_zone_page_state(zone, NR_LRU_BASE + l + LRU_ACTIVE,
+				      -delta);
+		__mod_zone_page_state(zone, NR_LRU_BASE + l, delta);
+	}
+
+	gen = lru_gen_from_seq(lrugen->max_seq + 1);
+	lrugen->timestamps[gen] = jiffies;
+	lrugen->max_seq++;
+out:
+	spin_unlock_irq(&zone->lru_lock);
+}
+
+static void lru_gen_age(struct zone *zone, bool can_swap)
+{
+	/*
+	 * Walking every mm is far too slow for direct reclaim, which
+	 * settles for the references shrink_page_list() finds through
+	 * rmap.  Nor is it worth walking twice for one generation.
+	 */
+	if (current_is_kswapd() && (lru_gen_state & LRU_GEN_MM_WALK) &&
+	    mutex_trylock(&lru_gen_mutex)) {
+		if (lru_gen_need_aging(zone, can_swap))
+			lru_gen_walk_mms();
+		mutex_unlock(&lru_gen_mutex);
+	}
+
+	inc_max_seq(zone, can_swap);
+}
+
+/*
+ * Anon is evicted when its oldest generation is older than that of file,
+ * or, when both are the same age, when it holds more pages than file
+ * after weighing each by swappiness, as get_scan_count() does.
+ */
+static int lru_gen_get_type(struct zone *zone, struct scan_control *sc)
+{
+	struct lru_gen_struct *lrugen = &zone->lrugen;
+	unsigned long anon_seq = lrugen->min_seq[LRU_GEN_ANON];
+	unsigned long file_seq = lrugen->min_seq[LRU_GEN_FILE];
+	unsigned long anon, file;
+
+	if (!sc->may_swap || nr_swap_pages <= 0 || !sc->swappiness)
+		return LRU_GEN_FILE;
+
+	if (anon_seq != file_seq)
+		return anon_seq < file_seq ? LRU_GEN_ANON : LRU_GEN_FILE;
+
+	anon = lrugen->nr_pages[lru_gen_from_seq(anon_seq)][LRU_GEN_ANON];
+	file = lrugen->nr_pages[lru_gen_from_seq(file_seq)][LRU_GEN_FILE];
+
+	return anon * sc->swappiness > file * (200 - sc->swappiness) ?
+	       LRU_GEN_ANON : LRU_GEN_FILE;
+}
+
+/*
+ * Isolate up to @nr_to_scan pages of @type from the tail of the oldest
+ * generation onto @dst, retiring the generation if it runs dry.
+ * zone->lru_lock must be held.
+ */
+static unsigned long lru_gen_isolate(struct zone *zone,
+				     struct scan_control *sc, int type,
+				     unsigned long nr_to_scan,
+				     struct list_head *dst,
+				     unsigned long *scanned)
+{
+	struct lru_gen_struct *lrugen = &zone->lrugen;
+	int gen = lru_gen_from_seq(lrugen->min_seq[type]);
+	struct list_head *src = &lrugen->lists[gen][type];
+	isolate_mode_t mode = ISOLATE_ACTIVE | ISOLATE_INACTIVE;
+	unsigned long nr_taken = 0;
+	unsigned long scan;
+
+	if (!sc->may_unmap)
+		mode |= ISOLATE_UNMAPPED;
+	if (!sc->may_writepage)
+		mode |= ISOLATE_CLEAN;
+
+	for (scan = 0; scan < nr_to_scan && !list_empty(src); scan++) {
+		struct page *page = lru_to_page(src);
+
+		prefetchw_prev_lru_page(page, src, flags);
+
+		VM_BUG_ON(!PageLRU(page));
+
+		switch (__isolate_lru_page(page, mode, type)) {
+		case 0:
+			lru_gen_del_page(zone, page, false);
+			list_add(&page->lru, dst);
+			nr_taken += hpage_nr_pages(page);
+			break;
+
+		case -EBUSY:
+			/* else it is being freed elsewhere */
+			list_move(&page->lru, src);
+			continue;
+
+		default:
+			BUG();
+		}
+	}
+
+	if (list_empty(src) &&
+	    lrugen->min_seq[type] + MIN_NR_GENS <= lrugen->max_seq)
+		inc_min_seq(zone, type);
+
+	*scanned = scan;
+	return nr_taken;
+}
+
+static unsigned long lru_gen_evict(struct zone *zone, struct scan_control *sc,
+				   int priority, unsigned long nr_to_scan)
+{
+	LIST_HEAD(page_list);
+	struct zone_reclaim_stat *reclaim_stat = get_reclaim_stat(zone, sc);
+	bool can_swap = sc->may_swap && nr_swap_pages > 0;
+	unsigned long nr_scanned;
+	unsigned long nr_reclaimed;
+	unsigned long nr_taken;
+	int type;
+
+	if (lru_gen_need_aging(zone, can_swap))
+		lru_gen_age(zone, can_swap);
+
+	type = lru_gen_get_type(zone, sc);
+
+	while (unlikely(too_many_isolated(zone, type, sc))) {
+		congestion_wait(BLK_RW_ASYNC, HZ/10);
+
+		/* We are about to die and free our memory. Return now. */
+		if (fatal_signal_pending(current))
+			return SWAP_CLUSTER_MAX;
+	}
+
+	/* only for reclaim/compaction: the lists are not scanned lumpily */
+	set_reclaim_mode(priority, sc, false);
+
+	lru_add_drain();
+
+	spin_lock_irq(&zone->lru_lock);
+
+	nr_taken = lru_gen_isolate(zone, sc, type, nr_to_scan, &page_list,
+				   &nr_scanned);
+	zone->pages_scanned += nr_scanned;
+	if (current_is_kswapd())
+		__count_zone_vm_events(PGSCAN_KSWAPD, zone, nr_scanned);
+	else
+		__count_zone_vm_events(PGSCAN_DIRECT, zone, nr_scanned);
+
+	if (nr_taken == 0) {
+		spin_unlock_irq(&zone->lru_lock);
+		return 0;
+	}
+
+	__mod_zone_page_state(zone, NR_ISOLATED_ANON + type, nr_taken);
+	reclaim_stat->recent_scanned[type] += nr_taken;
+
+	spin_unlock_irq(&zone->lru_lock);
+
+	nr_reclaimed = shrink_page_list(&page_list, zone, sc);
+
+	local_irq_disable();
+	if (current_is_kswapd())
+		__count_vm_events(KSWAPD_STEAL, nr_reclaimed);
+	__count_zone_vm_events(PGSTEAL, zone, nr_reclaimed);
+
+	putback_lru_pages(zone, sc, type ? 0 : nr_taken, type ? nr_taken : 0,
+			  &page_list);
+
+	return nr_reclaimed;
+}
+
+/*
+ * The multi-gen LRU counterpart of the get_scan_count() and shrink_list()
+ * loop in shrink_zone(): scan the evictable pages of @zone >> @priority,
+ * SWAP_CLUSTER_MAX at a time.
+ */
+static unsigned long lru_gen_shrink_zone(struct zone *zone,
+					 struct scan_control *sc, int priority)
+{
+	struct lru_gen_struct *lrugen = &zone->lrugen;
+	unsigned long nr_to_reclaim = sc->nr_to_reclaim;
+	unsigned long nr_reclaimed = 0;
+	unsigned long nr_to_scan = 0;
+	unsigned long nr;
+	struct blk_plug plug;
+	int gen, type;
+
+	for (gen = 0; gen < MAX_NR_GENS; gen++) {
+		for (type = 0; type < ANON_AND_FILE; type++) {
+			if (type == LRU_GEN_ANON &&
+			    (!sc->may_swap || nr_swap_pages <= 0))
+				continue;
+			nr_to_scan += max(lrugen->nr_pages[gen][type], 0L);
+		}
+	}
+	nr_to_scan >>= priority;
+
+	/* kswapd does zone balancing and needs to scan this zone */
+	if (!nr_to_scan && current_is_kswapd() && zone->all_unreclaimable)
+		nr_to_scan = SWAP_CLUSTER_MAX;
+
+	blk_start_plug(&plug);
+	while (nr_to_scan) {
+		nr = min_t(unsigned long, nr_to_scan, SWAP_CLUSTER_MAX);
+		nr_to_scan -= nr;
+
+		nr_reclaimed += lru_gen_evict(zone, sc, priority, nr);
+
+		if (nr_reclaimed >= nr_to_reclaim && priority < DEF_PRIORITY)
+			break;
+	}
+	blk_finish_plug(&plug);
+
+	return nr_reclaimed;
+}
+
+/*
+ * Move every evictable page of every zone onto the lists @enable selects,
+ * dropping zone->lru_lock every LRU_GEN_BATCH pages.  Pages added in the
+ * meantime already go to the new lists.
+ */
+static void lru_gen_change_state(bool enable)
+{
+	struct zone *zone;
+	struct page *page;
+	enum lru_list l;
+	int gen, type;
+	int batch = 0;
+
+	for_each_populated_zone(zone) {
+		spin_lock_irq(&zone->lru_lock);
+		if (enable) {
+			for_each_evictable_lru(l) {
+				struct list_head *head = &zone->lru[l].list;
+
+				while (!list_empty(head)) {
+					page = lru_to_page(head);
+					del_page_from_lru_list(zone, page, l);
+					add_page_to_lru_list(zone, page, l);
+					if (++batch % LRU_GEN_BATCH)
+						continue;
+					spin_unlock_irq(&zone->lru_lock);
+					cond_resched();
+					spin_lock_irq(&zone->lru_lock);
+				}
+			}
+		} else {
+			for (gen = 0; gen < MAX_NR_GENS; gen++) {
+				for (type = 0; type < ANON_AND_FILE; type++) {
+					struct list_head *head =
+						&zone->lrugen.lists[gen][type];
+
+					while (!list_empty(head)) {
+						page = lru_to_page(head);
+						/* sets PG_active if young */
+						del_page_from_lru_list(zone,
+							page, LRU_BASE);
+						add_page_to_lru_list(zone, page,
+							page_lru(page));
+						if (++batch % LRU_GEN_BATCH)
+							continue;
+						spin_unlock_irq(&zone->lru_lock);
+						cond_resched();
+						spin_lock_irq(&zone->lru_lock);
+					}
+				}
+			}
+		}
+		spin_unlock_irq(&zone->lru_lock);
+	}
+}
+
+#ifdef CONFIG_SYSFS
+static ssize_t lru_gen_enabled_show(struct kobject *kobj,
+				    struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "0x%04x\n", lru_gen_state);
+}
+
+/*
+ * Takes y or n, which also turn the page table walks on or off, or the
+ * mask of LRU_GEN_* features.
+ */
+static ssize_t lru_gen_enabled_store(struct kobject *kobj,
+				     struct kobj_attribute *attr,
+				     const char *buf, size_t count)
+{
+	unsigned int state;
+	bool was_enabled;
+	int err;
+
+	if (sysfs_streq(buf, "y"))
+		state = LRU_GEN_CORE | LRU_GEN_MM_WALK;
+	else if (sysfs_streq(buf, "n"))
+		state = 0;
+	else {
+		err = kstrtouint(buf, 0, &state);
+		if (err)
+			return err;
+		if (state & ~(LRU_GEN_CORE | LRU_GEN_MM_WALK))
+			return -EINVAL;
+	}
+	/* see lru_gen_enabled() */
+	if ((state & LRU_GEN_CORE) && !mem_cgroup_disabled())
+		return -EBUSY;
+
+	mutex_lock(&lru_gen_mutex);
+	was_enabled = lru_gen_enabled();
+	lru_gen_state = state;
+	if (lru_gen_enabled() != was_enabled) {
+		/* the pages on the per-cpu pagevecs go where they belong */
+		lru_add_drain_all();
+		lru_gen_change_state(lru_gen_enabled());
+	}
+	mutex_unlock(&lru_gen_mutex);
+
+	return count;
+}
+static struct kobj_attribute lru_gen_enabled_attr =
+	__ATTR(enabled, 0644, lru_gen_enabled_show, lru_gen_enabled_store);
+
+static struct attribute *lru_gen_attrs[] = {
+	&lru_gen_enabled_attr.attr,
+	NULL,
+};
+
+static struct attribute_group lru_gen_attr_group = {
+	.attrs = lru_gen_attrs,
+	.name = "lru_gen",
+};
+#endif /* CONFIG_SYSFS */
+
+#ifdef CONFIG_DEBUG_FS
+/*
+ * The generations and the active/inactive lists of @type must together
+ * hold the pages NR_ACTIVE_* and NR_INACTIVE_* count, and only one side
+ * may hold any while no switch of lru_gen_state is under way.
+ */
+static bool lru_gen_check_zone(struct zone *zone, int type,
+			       long *gens, long *lists, long *stat)
+{
+	struct lru_gen_struct *lrugen = &zone->lrugen;
+	enum lru_list l;
+	struct page *page;
+	int gen;
+
+	*gens = 0;
+	for (gen = 0; gen < MAX_NR_GENS; gen++)
+		*gens += lrugen->nr_pages[gen][type];
+
+	*lists = 0;
+	for_each_evictable_lru(l) {
+		if (is_file_lru(l) != type)
+			continue;
+		list_for_each_entry(page, &zone->lru[l].list, lru)
+			*lists += hpage_nr_pages(page);
+	}
+
+	l = type ? LRU_INACTIVE_FILE : LRU_INACTIVE_ANON;
+	*stat = zone_page_state_snapshot(zone, NR_LRU_BASE + l) +
+		zone_page_state_snapshot(zone, NR_LRU_BASE + l + LRU_ACTIVE);
+
+	if (*gens + *lists != *stat)
+		return false;
+	return lru_gen_enabled() ? !*lists : !*gens;
+}
+
+/*
+ * Reading lru_gen_check checks every zone: write y and n to
+ * /sys/kernel/mm/lru_gen/enabled in between to test both directions.
+ */
+static int lru_gen_check_show(struct seq_file *m, void *v)
+{
+	static const char *type_name[ANON_AND_FILE] = { "anon", "file" };
+	struct zone *zone;
+	long gens, lists, stat;
+	bool ok;
+	int type;
+
+	mutex_lock(&lru_gen_mutex);
+	for_each_populated_zone(zone) {
+		for (type = 0; type < ANON_AND_FILE; type++) {
+			spin_lock_irq(&zone->lru_lock);
+			ok = lru_gen_check_zone(zone, type,
+						&gens, &lists, &stat);
+			spin_unlock_irq(&zone->lru_lock);
+
+			seq_printf(m, "Node %d, zone %8s %s: gens %ld lists %ld"
+				   " stat %ld %s\n", zone_to_nid(zone),
+				   zone->name, type_name[type], gens, lists,
+				   stat, ok ? "ok" : "MISMATCH");
+			WARN_ON_ONCE(!ok);
+		}
+	}
+	mutex_unlock(&lru_gen_mutex);
+
+	return 0;
+}
+
+static int lru_gen_check_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, lru_gen_check_show, NULL);
+}
+
+static const struct file_operations lru_gen_check_fops = {
+	.open		= lru_gen_check_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int lru_gen_debugfs_show(struct seq_file *m, void *v)
+{
+	struct zone *zone;
+	unsigned long seq;
+
+	for_each_populated_zone(zone) {
+		struct lru_gen_struct *lrugen = &zone->lrugen;
+
+		seq_printf(m, "Node %d, zone %8s\n",
+			   zone_to_nid(zone), zone->name);
+
+		spin_lock_irq(&zone->lru_lock);
+		seq = min(lrugen->min_seq[LRU_GEN_ANON],
+			  lrugen->min_seq[LRU_GEN_FILE]);
+		for (; seq <= lrugen->max_seq; seq++) {
+			int gen = lru_gen_from_seq(seq);
+
+			seq_printf(m, " %10lu %10u %10ld %10ld\n", seq,
+				   jiffies_to_msecs(jiffies -
+						    lrugen->timestamps[gen]),
+				   lrugen->nr_pages[gen][LRU_GEN_ANON],
+				   lrugen->nr_pages[gen][LRU_GEN_FILE]);
+		}
+		spin_unlock_irq(&zone->lru_lock);
+	}
+
+	return 0;
+}
+
+static int lru_gen_debugfs_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, lru_gen_debugfs_show, NULL);
+}
+
+static const struct file_operations lru_gen_debugfs_fops = {
+	.open		= lru_gen_debugfs_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+#endif /* CONFIG_DEBUG_FS */
+
+static int __init lru_gen_init(void)
+{
+	if ((lru_gen_state & LRU_GEN_CORE) && !mem_cgroup_disabled()) {
+		printk(KERN_INFO "lru_gen: not used with the memory controller, "
+		       "boot with cgroup_disable=memory to use it\n");
+		lru_gen_state = 0;
+	}
+#ifdef CONFIG_SYSFS
+	if (sysfs_create_group(mm_kobj, &lru_gen_attr_group))
+		printk(KERN_ERR "lru_gen: register sysfs failed\n");
+#endif
+#ifdef CONFIG_DEBUG_FS
+	debugfs_create_file("lru_gen", 0444, NULL, NULL,
+			    &lru_gen_debugfs_fops);
+	debugfs_create_file("lru_gen_check", 0400, NULL, NULL,
+			    &lru_gen_check_fops);
+#endif
+	return 0;
+}
+/* after mm_init.o has set up mm_kobj */
+late_initcall(lru_gen_init);
+#else /* !CONFIG_LRU_GEN */
+static inline unsigned long lru_gen_shrink_zone(struct zone *zone,
+						struct scan_control *sc,
+						int priority)
+{
+	return 0;
+}
+#endif /* CONFIG_LRU_GEN */
+
 /*
  * This is a basic per-zone page freer.  Used by both kswapd and direct reclaim.
  */
@@ -2058,6 +2810,10 @@ static void shrink_zone(int priority, struct zone *zone,
 restart:
 	nr_reclaimed = 0;
 	nr_scanned = sc->nr_scanned;
+	if (lru_gen_enabled()) {
+		nr_reclaimed = lru_gen_shrink_zone(zone, sc, priority);
+		goto reclaimed;
+	}
 	get_scan_count(zone, sc, nr, priority);
 
 	blk_start_plug(&plug);
@@ -2085,6 +2841,7 @@ restart:
 			break;
 	}
 	blk_finish_plug(&plug);
+reclaimed:
 	sc->nr_reclaimed += nr_reclaimed;
 
 	/*
@@ -2915,6 +3672,12 @@ static void kswapd_try_to_sleep(pg_data_t *pgdat, int order, int classzone_idx)
 		 */
 		set_pgdat_percpu_threshold(pgdat, calculate_normal_threshold);
 
+		/*
+		 * The node is balanced: a good time to compact it, before
+		 * a high-order allocation has to.
+		 */
+		wakeup_kcompactd(pgdat);
+
 		if (!kthread_should_stop())
 			schedule();
 
@@ -3476,10 +4239,8 @@ retry:
 	if (page_evictable(page, NULL)) {
 		enum lru_list l = page_lru_base_type(page);
 
-		__dec_zone_state(zone, NR_UNEVICTABLE);
-		list_move(&page->lru, &zone->lru[l].list);
-		mem_cgroup_move_lists(page, LRU_UNEVICTABLE, l);
-		__inc_zone_state(zone, NR_INACTIVE_ANON + l);
+		del_page_from_lru_list(zone, page, LRU_UNEVICTABLE);
+		add_page_to_lru_list(zone, page, l);
 		__count_vm_event(UNEVICTABLE_PGRESCUED);
 	} else {
 		/*
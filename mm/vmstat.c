@@ -416,6 +416,19 @@ void dec_zone_page_state(struct page *page, enum zone_stat_item item)
 EXPORT_SYMBOL(dec_zone_page_state);
 #endif
 
+#ifdef CONFIG_NUMA
+/* The pages and high-order blocks on the lists of @p */
+static int pageset_count(struct per_cpu_pageset *p)
+{
+	int count = p->pcp.count;
+	int order;
+
+	for (order = 1; order <= PCP_MAX_ORDER; order++)
+		count += p->pcp_order[order - 1].count;
+	return count;
+}
+#endif
+
 /*
  * Update the zone counters for one cpu.
  *
@@ -470,7 +483,7 @@ void refresh_cpu_vm_stats(int cpu)
 		 * Check if there are pages remaining in this pageset
 		 * if not then there is nothing to expire.
 		 */
-		if (!p->expire || !p->pcp.count)
+		if (!p->expire || !pageset_count(p))
 			continue;
 
 		/*
@@ -485,8 +498,8 @@ void refresh_cpu_vm_stats(int cpu)
 		if (p->expire)
 			continue;
 
-		if (p->pcp.count)
-			drain_zone_pages(zone, &p->pcp);
+		if (pageset_count(p))
+			drain_zone_pages(zone, p);
 #endif
 	}
 
@@ -708,6 +721,8 @@ const char * const vmstat_text[] = {
 	"nr_shmem",
 	"nr_dirtied",
 	"nr_written",
+	"workingset_refault",
+	"workingset_activate",
 
 #ifdef CONFIG_NUMA
 	"numa_hit",
@@ -735,6 +750,7 @@ const char * const vmstat_text[] = {
 
 	"pgfault",
 	"pgmajfault",
+	"pgfaultaround",
 
 	TEXTS_FOR_ZONES("pgrefill")
 	TEXTS_FOR_ZONES("pgsteal")
@@ -756,6 +772,11 @@ const char * const vmstat_text[] = {
 
 	"pgrotated",
 
+#ifdef CONFIG_SWAP
+	"swap_ra",
+	"swap_ra_hit",
+#endif
+
 #ifdef CONFIG_COMPACTION
 	"compact_blocks_moved",
 	"compact_pages_moved",
@@ -763,6 +784,10 @@ const char * const vmstat_text[] = {
 	"compact_stall",
 	"compact_fail",
 	"compact_success",
+	"compact_daemon_wake",
+	"compact_daemon_success",
+	"compact_daemon_fail",
+	"compact_daemon_time_ms",
 #endif
 
 #ifdef CONFIG_HUGETLB_PAGE
@@ -966,7 +991,7 @@ static const struct file_operations pagetypeinfo_file_ops = {
 static void zoneinfo_show_print(struct seq_file *m, pg_data_t *pgdat,
 							struct zone *zone)
 {
-	int i;
+	int i, j;
 	seq_printf(m, "Node %d, zone %8s", pgdat->node_id, zone->name);
 	seq_printf(m,
 		   "\n  pages free     %lu"
@@ -1009,6 +1034,13 @@ static void zoneinfo_show_print(struct seq_file *m, pg_data_t *pgdat,
 			   pageset->pcp.count,
 			   pageset->pcp.high,
 			   pageset->pcp.batch);
+		for (j = 1; j <= PCP_MAX_ORDER; j++)
+			seq_printf(m,
+				   "\n      order %d: count: %i high: %i batch: %i",
+				   j,
+				   pageset->pcp_order[j - 1].count,
+				   pageset->pcp_order[j - 1].high,
+				   pageset->pcp_order[j - 1].batch);
 #ifdef CONFIG_SMP
 		seq_printf(m, "\n  vm stats threshold: %d",
 				pageset->stat_threshold);
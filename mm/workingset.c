@@ -0,0 +1,152 @@
+/*
+ * Workingset detection
+ *
+ * Copyright (C) 2013 Red Hat, Inc., Johannes Weiner
+ */
+
+#include <linux/memcontrol.h>
+#include <linux/writeback.h>
+#include <linux/pagemap.h>
+#include <linux/atomic.h>
+#include <linux/module.h>
+#include <linux/swap.h>
+#include <linux/fs.h>
+#include <linux/mm.h>
+
+/*
+ *		Double CLOCK lists
+ *
+ * Per zone, two clock lists are maintained for file pages: the
+ * inactive and the active list.  Freshly faulted pages start out at
+ * the head of the inactive list and page reclaim scans pages from the
+ * tail.  Pages that are accessed multiple times on the inactive list
+ * are promoted to the active list, to protect them from reclaim,
+ * whereas active pages are demoted to the inactive list when the
+ * active list grows too big.
+ *
+ * A page that is evicted from the inactive list before it is accessed
+ * a second time cannot be told apart from a page that is used only
+ * once, even when the inactive list is simply too small to hold the
+ * workingset.  A streaming read then keeps the active list at its old
+ * size while the real workingset thrashes on the inactive list.
+ *
+ *		Refault distance
+ *
+ * Every eviction from the inactive list and every activation moves
+ * the zone's inactive_age counter one step forward.  An evicted page
+ * leaves the counter's value behind, as a shadow entry in the page
+ * cache slot it occupied.  When the page is faulted back in, the
+ * difference between the current counter and the shadow is the number
+ * of inactive list slots the page would have needed on top of the
+ * ones it had in order to stay in memory: its refault distance.
+ *
+ * If the refault distance is smaller than the active list, the page
+ * would have been kept had that space been given to the inactive
+ * list.  Such a page is activated right away, and has to compete with
+ * the existing active pages for its place; a page with a larger
+ * distance could not have been saved by any sizing of the lists and
+ * starts out inactive like any new page.
+ *
+ *		Shadow entries
+ *
+ * Shadows are exceptional radix tree entries, so they cost no memory
+ * beyond the tree nodes they keep alive.  They are removed when a page
+ * is faulted into their slot, on truncation, and when the inode is
+ * evicted.  To bound the nodes one mapping can keep alive, a mapping
+ * stops collecting shadows once it holds as many as there are file
+ * pages on the LRU: an older shadow could not have a refault distance
+ * smaller than the active list anyway.
+ */
+
+#define EVICTION_SHIFT	(RADIX_TREE_EXCEPTIONAL_SHIFT + \
+			 ZONES_SHIFT + NODES_SHIFT)
+#define EVICTION_MASK	(~0UL >> EVICTION_SHIFT)
+
+static void *pack_shadow(unsigned long eviction, struct zone *zone)
+{
+	eviction = (eviction << NODES_SHIFT) | zone_to_nid(zone);
+	eviction = (eviction << ZONES_SHIFT) | zone_idx(zone);
+	eviction = (eviction << RADIX_TREE_EXCEPTIONAL_SHIFT);
+
+	return (void *)(eviction | RADIX_TREE_EXCEPTIONAL_ENTRY);
+}
+
+static void unpack_shadow(void *shadow, struct zone **zone,
+			  unsigned long *distance)
+{
+	unsigned long entry = (unsigned long)shadow;
+	unsigned long eviction;
+	unsigned long refault;
+	int zid, nid;
+
+	entry >>= RADIX_TREE_EXCEPTIONAL_SHIFT;
+	zid = entry & ((1UL << ZONES_SHIFT) - 1);
+	entry >>= ZONES_SHIFT;
+	nid = entry & ((1UL << NODES_SHIFT) - 1);
+	entry >>= NODES_SHIFT;
+	eviction = entry;
+
+	*zone = NODE_DATA(nid)->node_zones + zid;
+
+	refault = atomic_long_read(&(*zone)->inactive_age);
+	*distance = (refault - eviction) & EVICTION_MASK;
+}
+
+/**
+ * workingset_eviction - note the eviction of a page from memory
+ * @mapping: address space the page was backing
+ * @page: the page being evicted
+ *
+ * Returns a shadow entry to be stored in @mapping->page_tree in place
+ * of the evicted @page, or NULL if @mapping holds enough shadows
+ * already, so that a later refault can be detected.  The eviction is
+ * counted in either case, or the refault distances of every other
+ * mapping would come out too short while one mapping streams.
+ *
+ * Called with @mapping->tree_lock held.
+ */
+void *workingset_eviction(struct address_space *mapping, struct page *page)
+{
+	struct zone *zone = page_zone(page);
+	unsigned long eviction;
+
+	eviction = atomic_long_inc_return(&zone->inactive_age);
+	if (mapping->nrshadows >= global_page_state(NR_ACTIVE_FILE) +
+				  global_page_state(NR_INACTIVE_FILE))
+		return NULL;
+
+	return pack_shadow(eviction, zone);
+}
+
+/**
+ * workingset_refault - evaluate the refault of a previously evicted page
+ * @shadow: shadow entry of the evicted page
+ *
+ * Calculates and evaluates the refault distance of the previously
+ * evicted page in the context of the zone it was allocated in.
+ *
+ * Returns %true if the page should be activated, %false otherwise.
+ */
+bool workingset_refault(void *shadow)
+{
+	unsigned long refault_distance;
+	struct zone *zone;
+
+	unpack_shadow(shadow, &zone, &refault_distance);
+	inc_zone_state(zone, WORKINGSET_REFAULT);
+
+	if (refault_distance <= zone_page_state(zone, NR_ACTIVE_FILE)) {
+		inc_zone_state(zone, WORKINGSET_ACTIVATE);
+		return true;
+	}
+	return false;
+}
+
+/**
+ * workingset_activation - note a page activation
+ * @page: page that is being activated
+ */
+void workingset_activation(struct page *page)
+{
+	atomic_long_inc(&page_zone(page)->inactive_age);
+}